@@ -15,6 +15,7 @@
 #include <ctype.h>
 #include <sys/wait.h>
 #include <sys/select.h>
+#include <sys/resource.h>
 #include <errno.h>
 #include "config.h"
 #include "doctor.h"
@@ -24,6 +25,16 @@
 #include "msq.h"
 #include "triage.h"
 #include "log.h"
+#include "sock.h"
+#include "affinity.h"
+#include "group.h"
+#include "checkpoint.h"
+#include "trace.h"
+#include "timeline.h"
+#include "lockstat.h"
+#include "rolling.h"
+#include "reload.h"
+#include "scaleout.h"
 
 #define DEBUG 
 
@@ -33,12 +44,25 @@ Config global_config;
 /* Flag para terminação controlada */
 volatile sig_atomic_t keep_running = 1;
 
+/* Drenagem: entrada fechada, Doctors continuam a atender o que está em fila */
+volatile sig_atomic_t draining = 0;
+volatile sig_atomic_t drain_aborted = 0;   // Segundo SIGINT: terminar já
+
+/* Trabalho adiado dos handlers para o ciclo principal (fork e log não são
+ * seguros dentro de um handler) */
+volatile sig_atomic_t child_exited = 0;      // SIGCHLD: recolher os filhos
+volatile sig_atomic_t reload_requested = 0;  // SIGHUP: recarregar config.txt
+volatile sig_atomic_t stats_requested = 0;   // SIGUSR1: mostrar estatísticas
+
 /* Contador de pacientes */
 int patient_counter = 0;
 
 /* File descriptor do named pipe */
 int pipe_fd = -1;
 
+/* File descriptor do named pipe binário */
+int batch_pipe_fd = -1;
+
 /*
  * Bloqueia sinais indesejados 
  */
@@ -49,7 +73,6 @@ void block_unwanted_signals() {
     sigemptyset(&block_set);
     
     // Adicionar sinais a bloquear  
-    sigaddset(&block_set, SIGHUP);    // Ignorar desconexão de terminal
     sigaddset(&block_set, SIGQUIT);   // Ignorar SIGQUIT (Ctrl+\)
     sigaddset(&block_set, SIGTSTP);   // Ignorar Ctrl+Z
     sigaddset(&block_set, SIGTTIN);   // Ignorar leitura em background
@@ -63,7 +86,7 @@ void block_unwanted_signals() {
     } else {
         write_log("Sinais indesejados bloqueados com sucesso");
         #ifdef DEBUG
-        write_log("DEBUG: SIGTERM, SIGHUP, SIGQUIT, SIGTSTP, SIGTTIN, SIGTTOU, SIGPIPE bloqueados");
+        write_log("DEBUG: SIGQUIT, SIGTSTP, SIGTTIN, SIGTTOU, SIGPIPE bloqueados");
         #endif
     }
 }
@@ -71,20 +94,46 @@ void block_unwanted_signals() {
 /* Handler para SIGINT */
 void sigint_handler(int signum) {
     (void)signum;
+    if (!keep_running) {
+        write_log("SINAL: SIGINT recebido novamente - Drenagem interrompida");
+        drain_aborted = 1;
+        return;
+    }
     write_log("SINAL: SIGINT recebido - Iniciando terminação controlada");
     keep_running = 0;
 }
 
-/* Handler para SIGUSR1 */
+/* Handler para SIGUSR1 - só marca; as estatísticas são mostradas em show_statistics() */
 void sigusr1_handler(int signum) {
     (void)signum;
-    // Guardar errno para não interferir com syscalls
-    int saved_errno = errno;
+    stats_requested = 1;
+}
+
+/* Handler para SIGCHLD - só marca; os filhos são recolhidos em reap_children() */
+void sigchld_handler(int signum) {
+    (void)signum;
+    child_exited = 1;
+}
+
+/* Handler para SIGHUP - pede o recarregamento de config.txt */
+void sighup_handler(int signum) {
+    (void)signum;
+    reload_requested = 1;
+}
+
+/*
+ * Mostra as estatísticas pedidas por SIGUSR1 (chamado no ciclo principal
+ * e na drenagem: print_statistics adquire o mutex da memória partilhada,
+ * que a thread principal pode já ter quando o sinal chega)
+ */
+static void show_statistics() {
+    stats_requested = 0;
     
     write_log("SINAL: SIGUSR1 recebido - Estatísticas solicitadas");
     
-    // Ler e apresentar estatísticas da memória partilhada
+    // Ler e apresentar estatísticas da memória partilhada e dos mutexes
     print_statistics();
+    print_lockstat();
     
     // Mostrar também o estado das filas
     int queue_size = get_queue_size();
@@ -101,58 +150,101 @@ void sigusr1_handler(int signum) {
                   triage_queue->count, triage_queue->capacity);
         pthread_mutex_unlock(&triage_queue->mutex);
     }
-    
-    // Restaurar errno
-    errno = saved_errno;
 }
 
-/* Handler para SIGCHLD - detetar quando um Doctor termina */
-void sigchld_handler(int signum) {
-    (void)signum;
-    // Guardar errno
-    int saved_errno = errno;
-    
+/*
+ * Recolhe os processos filhos que terminaram e substitui os Doctors
+ * permanentes que acabaram o turno (chamado no ciclo principal e na
+ * drenagem depois de um SIGCHLD)
+ */
+static void reap_children() {
     pid_t pid;
     int status;
     
+    child_exited = 0;
+    
     // Recolher todos os processos filhos que terminaram
     while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
-        int found = 0;
+        // Verificar se é um doctor temporário ou da pool de espera
+        if (handle_temporary_doctor_exit(pid, status)) {
+            continue;
+        }
         
-        // Verificar se é um doctor permanente
-        if (doctors_array != NULL) {
-            for (int i = 0; i < global_config.doctors; i++) {
-                if (doctors_array[i].pid == pid) {
-                    write_log("Doctor %d (PID: %d) terminou o turno", 
-                             doctors_array[i].id, pid);
-                    
-                    // Se o sistema ainda está a correr, criar novo Doctor
-                    if (keep_running) {
-                        write_log("A criar novo Doctor %d para substituir...", 
-                                 doctors_array[i].id);
-                        create_doctor_process(doctors_array[i].id, &global_config);
-                    }
-                    found = 1;
-                    break;
-                }
+        // Doctor permanente: substituir se o sistema ainda está a correr (ou a drenar)
+        if (handle_permanent_doctor_exit(pid, keep_running || draining, &global_config)) {
+            continue;
+        }
+        
+        write_log("Processo filho desconhecido (PID: %d) terminou", pid);
+    }
+}
+
+/*
+ * Drenagem: com a entrada de pacientes já fechada, deixa a triagem e os
+ * Doctors escoarem as filas durante até DRAIN_TIMEOUT_MS
+ * O coordenador espera também pelos front-ends; um front-end só escoa a
+ * sua triagem para a fila de atendimento
+ * Um segundo SIGINT interrompe a espera
+ * Retorna 0 se as filas ficaram vazias, -1 caso contrário
+ */
+static int drain_patients() {
+    if (global_config.drain_timeout_ms <= 0 || triage_queue == NULL) {
+        return -1;
+    }
+    
+    write_log("A escoar pacientes em fila (máximo %d ms)...", global_config.drain_timeout_ms);
+    printf("A escoar pacientes em fila (máximo %d ms, Ctrl+C para interromper)...\n",
+           global_config.drain_timeout_ms);
+    
+    struct timespec start, now;
+    struct timespec pause = {0, 10 * 1000000L};   // 10 ms entre verificações
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    
+    int drained = 0;
+    long elapsed_ms = 0;
+    draining = 1;
+    
+    while (!drain_aborted && elapsed_ms < global_config.drain_timeout_ms) {
+        if (get_triage_pending(triage_queue) == 0 &&
+            (frontend_id > 0 || (get_queue_size() == 0 && running_frontends() == 0))) {
+            drained = 1;
+            break;
+        }
+        
+        if (stats_requested) {
+            show_statistics();
+        }
+        
+        if (frontend_id == 0) {
+            if (child_exited) {
+                reap_children();
             }
-        }      
-        // Se não foi encontrado, é um doctor temporário
-        if (!found && num_temporary_doctors > 0) {
-            num_temporary_doctors--;
-            write_log("Doctor temporário (PID: %d) terminou. Temporários restantes: %d", 
-                     pid, num_temporary_doctors);
+            
+            // O controlador de pico continua ativo para escoar mais depressa
+            adjust_temporary_doctors(&global_config);
         }
+        nanosleep(&pause, NULL);
+        
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        elapsed_ms = (now.tv_sec - start.tv_sec) * 1000 + (now.tv_nsec - start.tv_nsec) / 1000000;
     }
-    // Restaurar errno
-    errno = saved_errno;
+    
+    draining = 0;
+    
+    if (drained) {
+        write_log("Filas escoadas em %ld ms", elapsed_ms);
+    } else {
+        write_log("AVISO: Drenagem terminada com pacientes em fila (%ld ms)", elapsed_ms);
+    }
+    
+    return drained ? 0 : -1;
 }
 
 /*
  * Configura os handlers de sinais
  */
 void setup_signal_handlers() {
-    struct sigaction sa_int, sa_usr1, sa_chld;
+    struct sigaction sa_int, sa_usr1, sa_chld, sa_hup;
     
     // Bloquear sinais indesejados
     block_unwanted_signals();
@@ -187,6 +279,16 @@ void setup_signal_handlers() {
         exit(EXIT_FAILURE);
     }
     
+    // Configurar handler para SIGHUP (recarregar config.txt)
+    sa_hup.sa_handler = sighup_handler;
+    sigemptyset(&sa_hup.sa_mask);
+    sa_hup.sa_flags = SA_RESTART;
+    
+    if (sigaction(SIGHUP, &sa_hup, NULL) == -1) {
+        perror("Erro ao configurar handler SIGHUP");
+        exit(EXIT_FAILURE);
+    }
+    
     // Ignorar SIGPIPE explicitamente (caso não tenha sido bloqueado)
     signal(SIGPIPE, SIG_IGN);
     
@@ -194,13 +296,56 @@ void setup_signal_handlers() {
     write_log("  - SIGINT: Terminação controlada");
     write_log("  - SIGUSR1: Mostrar estatísticas");
     write_log("  - SIGCHLD: Monitorizar processos filhos");
+    write_log("  - SIGHUP: Recarregar config.txt");
+}
+
+/*
+ * Reserva 'count' números de chegada seguidos no contador da memória
+ * partilhada (no modo scale-out é comum ao coordenador e aos front-ends)
+ * Retorna o primeiro número; patient_counter fica com o último
+ */
+static int reserve_arrival_numbers(int count) {
+    int first = atomic_fetch_add(&shm_stats->arrival_counter, count) + 1;
+    patient_counter = first + count - 1;
+    return first;
+}
+
+/*
+ * Gera o nome automático de um paciente (AAAAMMDD-NNN)
+ */
+static void generate_patient_name(char *name, int number) {
+    char prefix[16];
+    format_name_prefix(prefix, sizeof(prefix));
+    snprintf(name, MAX_NAME_LENGTH, "%s%03d", prefix, number);
+}
+
+/*
+ * Coloca vários pacientes na fila de triagem de uma só vez
+ * Os que não couberem são descartados (sem um registo de log por paciente)
+ * Retorna o número de pacientes admitidos
+ */
+static int admit_patients(Patient **patients, int count, IngestResult *result) {
+    int added = enqueue_patients(triage_queue, patients, count);
+    if (added < 0) {
+        added = 0;
+    }
+    
+    for (int i = added; i < count; i++) {
+        free_patient(patients[i]);
+    }
+    
+    result->accepted += added;
+    result->dropped += count - added;
+    
+    return added;
 }
 
 /*
- * Processa uma linha recebida do named pipe
+ * Processa uma linha recebida do named pipe ou do socket de ingestão
  * Formato: "João 10 50 1" ou "8 10 65 3" ou "TRIAGE=10"
+ * Acumula em 'result' os pacientes aceites/descartados e as linhas rejeitadas
  */
-void process_pipe_input(const char *line) {
+void process_pipe_input(const char *line, IngestResult *result) {
     char name[MAX_NAME_LENGTH];
     int triage_time, attendance_time, priority;
     int count;
@@ -226,6 +371,7 @@ void process_pipe_input(const char *line) {
         if (new_triage_value <= 0 || new_triage_value > 100) {
             write_log("ERRO: Valor inválido para TRIAGE (%d). Deve estar entre 1 e 100.", 
                      new_triage_value);
+            result->rejected++;
             return;
         }
         
@@ -234,8 +380,10 @@ void process_pipe_input(const char *line) {
         
         // Aplicar alteração
         if (change_triage_threads(new_triage_value, &global_config) == 0) {
+            result->accepted++;
             write_log("Configuração TRIAGE atualizada para %d threads", new_triage_value);
         } else {
+            result->rejected++;
             write_log("ERRO: Falha ao alterar número de threads de triagem");
         }
         
@@ -249,64 +397,57 @@ void process_pipe_input(const char *line) {
             // Validar valores
             if (count <= 0 || count > 1000) {
                 write_log("ERRO: Número de pacientes inválido (%d). Deve estar entre 1 e 1000", count);
+                result->rejected++;
                 return;
             }
             
             if (triage_time <= 0 || triage_time > 10000) {
                 write_log("ERRO: Tempo de triagem inválido (%d ms). Deve estar entre 1 e 10000", triage_time);
+                result->rejected++;
                 return;
             }
             
             if (attendance_time <= 0 || attendance_time > 100000) {
                 write_log("ERRO: Tempo de atendimento inválido (%d ms). Deve estar entre 1 e 100000", attendance_time);
+                result->rejected++;
                 return;
             }
             
             if (priority < 1 || priority > 5) {
                 write_log("ERRO: Prioridade inválida (%d). Deve estar entre 1 (mais urgente) e 5 (menos urgente)", priority);
+                result->rejected++;
                 return;
             }
             
             write_log("RECEÇÃO: Grupo de %d pacientes (triagem=%dms, atend=%dms, prior=%d)",
                      count, triage_time, attendance_time, priority);
             
-            int success_count = 0;
-            int failed_count = 0;
+            // Caminho rápido: uma alocação, um prefixo de nome e um lock para todo o grupo
+            char prefix[16];
+            format_name_prefix(prefix, sizeof(prefix));
             
+            int first_number = reserve_arrival_numbers(count);
+            Patient *group = create_patient_batch(count, first_number, prefix,
+                                                  triage_time, attendance_time, priority);
+            if (group == NULL) {
+                write_log("ERRO: Falha ao criar grupo de %d pacientes", count);
+                result->dropped += count;
+                return;
+            }
+            
+            Patient *group_ptrs[1000];
             for (int i = 0; i < count; i++) {
-                patient_counter++;
-                
-                // Gerar nome automático
-                time_t now = time(NULL);
-                struct tm *tm_info = localtime(&now);
-                snprintf(name, MAX_NAME_LENGTH, "%04d%02d%02d-%03d",
-                        tm_info->tm_year + 1900, tm_info->tm_mon + 1, 
-                        tm_info->tm_mday, patient_counter);
-                
-                Patient *patient = create_patient(patient_counter, name, 
-                                                 triage_time, attendance_time, priority);
-                
-                if (patient != NULL) {
-                    write_log("PACIENTE: %s criado (Nº %d)", name, patient_counter);
-                    
-                    // Adicionar à fila de triagem
-                    if (enqueue_patient(triage_queue, patient) != 0) {
-                        write_log("ERRO: Paciente %s descartado (fila de triagem cheia)", name);
-                        free_patient(patient);
-                        failed_count++;
-                    } else {
-                        write_log("TRIAGEM: Paciente %s adicionado à fila", name);
-                        success_count++;
-                    }
-                } else {
-                    write_log("ERRO: Falha ao criar paciente");
-                    failed_count++;
-                }
+                group_ptrs[i] = &group[i];
             }
             
-            write_log("RESUMO: %d pacientes adicionados, %d descartados", success_count, failed_count);
+            int success_count = admit_patients(group_ptrs, count, result);
+            int failed_count = count - success_count;
+            
+            write_log("RESUMO: Pacientes %s%03d a %s%03d: %d adicionados, %d descartados",
+                     prefix, first_number, prefix, patient_counter, success_count, failed_count);
             
         } else {
+            result->rejected++;
             write_log("ERRO: Formato inválido para grupo de pacientes. Formato esperado: 'N triage atend prior'");
             write_log("      Exemplo: '5 20 100 2' (5 pacientes, 20ms triagem, 100ms atend, prioridade 2)");
         }
@@ -317,25 +458,29 @@ void process_pipe_input(const char *line) {
             if (strlen(name) == 0 || strlen(name) >= MAX_NAME_LENGTH) {
                 write_log("ERRO: Nome inválido (tamanho: %zu). Deve ter entre 1 e %d caracteres", 
                          strlen(name), MAX_NAME_LENGTH - 1);
+                result->rejected++;
                 return;
             }
             
             if (triage_time <= 0 || triage_time > 10000) {
                 write_log("ERRO: Tempo de triagem inválido (%d ms). Deve estar entre 1 e 10000", triage_time);
+                result->rejected++;
                 return;
             }
             
             if (attendance_time <= 0 || attendance_time > 100000) {
                 write_log("ERRO: Tempo de atendimento inválido (%d ms). Deve estar entre 1 e 100000", attendance_time);
+                result->rejected++;
                 return;
             }
             
             if (priority < 1 || priority > 5) {
                 write_log("ERRO: Prioridade inválida (%d). Deve estar entre 1 (mais urgente) e 5 (menos urgente)", priority);
+                result->rejected++;
                 return;
             }
             
-            patient_counter++;
+            reserve_arrival_numbers(1);
             
             write_log("RECEÇÃO: Paciente '%s' (triagem=%dms, atend=%dms, prior=%d)",
                      name, triage_time, attendance_time, priority);
@@ -350,13 +495,17 @@ void process_pipe_input(const char *line) {
                 if (enqueue_patient(triage_queue, patient) != 0) {
                     write_log("ERRO: Paciente %s descartado (fila de triagem cheia)", name);
                     free_patient(patient);
+                    result->dropped++;
                 } else {
+                    result->accepted++;
                     write_log("TRIAGEM: Paciente %s adicionado à fila", name);
                 }
             } else {
+                result->dropped++;
                 write_log("ERRO: Falha ao criar paciente %s", name);
             }
         } else {
+            result->rejected++;
             write_log("ERRO: Formato inválido. Formatos esperados:");
             write_log("      Paciente: 'Nome triage atend prior' (ex: 'João 15 60 1')");
             write_log("      Grupo: 'N triage atend prior' (ex: '5 20 100 2')");
@@ -365,6 +514,13 @@ void process_pipe_input(const char *line) {
     }
 }
 
+/*
+ * Conta os pacientes de uma leitura/mensagem nas janelas de 1/10/60 s
+ */
+static void record_ingest(const IngestResult *result) {
+    rolling_record_ingest(result->accepted + result->dropped, result->dropped);
+}
+
 /*
  * Lê dados do named pipe (não-bloqueante)
  */
@@ -373,6 +529,7 @@ void read_from_pipe() {
     static int buffer_pos = 0;
     
     char temp[PIPE_BUFFER_SIZE];
+    IngestResult result = {0, 0, 0};
     ssize_t bytes_read = read(pipe_fd, temp, sizeof(temp) - 1);
     
     if (bytes_read > 0) {
@@ -383,7 +540,7 @@ void read_from_pipe() {
             if (temp[i] == '\n' || temp[i] == '\r') {
                 if (buffer_pos > 0) {
                     buffer[buffer_pos] = '\0';
-                    process_pipe_input(buffer);
+                    process_pipe_input(buffer, &result);
                     buffer_pos = 0;
                 }
             } else {
@@ -395,18 +552,288 @@ void read_from_pipe() {
     } else if (bytes_read == -1 && errno != EAGAIN && errno != EWOULDBLOCK) {
         write_log("ERRO: Falha ao ler do named pipe");
     }
+    
+    record_ingest(&result);
+}
+
+/*
+ * Valida um registo do protocolo binário e cria o respetivo paciente
+ * Retorna 1 em caso de sucesso, 0 se falhou a alocação, -1 se o registo é inválido
+ */
+static int create_batch_patient(const BatchRecord *record, Patient **patient) {
+    char name[MAX_NAME_LENGTH];
+    
+    if (record->triage_time <= 0 || record->triage_time > 10000 ||
+        record->attendance_time <= 0 || record->attendance_time > 100000 ||
+        record->priority < 1 || record->priority > 5) {
+        return -1;
+    }
+    
+    reserve_arrival_numbers(1);
+    
+    // Nome vazio: gerar nome automático como nos grupos
+    if (record->name[0] == '\0') {
+        generate_patient_name(name, patient_counter);
+    } else {
+        size_t len = strnlen(record->name, BATCH_NAME_LENGTH);
+        memcpy(name, record->name, len);
+        name[len] = '\0';
+    }
+    
+    *patient = create_patient(patient_counter, name, record->triage_time,
+                              record->attendance_time, record->priority);
+    
+    return (*patient != NULL) ? 1 : 0;
+}
+
+/*
+ * Cria e admite 'count' registos binários contíguos, em blocos de
+ * BATCH_ADMIT_CHUNK pacientes por aquisição do mutex da fila de triagem
+ */
+static void admit_batch_records(const unsigned char *records, size_t count, IngestResult *result) {
+    Patient *pending[BATCH_ADMIT_CHUNK];
+    int num_pending = 0;
+    
+    for (size_t i = 0; i < count; i++) {
+        BatchRecord record;
+        memcpy(&record, records + i * sizeof(BatchRecord), sizeof(record));
+        
+        Patient *patient = NULL;
+        int status = create_batch_patient(&record, &patient);
+        
+        if (status < 0) {
+            result->rejected++;
+        } else if (status == 0) {
+            result->dropped++;
+        } else {
+            pending[num_pending++] = patient;
+            if (num_pending == BATCH_ADMIT_CHUNK) {
+                admit_patients(pending, num_pending, result);
+                num_pending = 0;
+            }
+        }
+    }
+    
+    if (num_pending > 0) {
+        admit_patients(pending, num_pending, result);
+    }
+}
+
+/*
+ * Processa um frame binário completo recebido numa única mensagem
+ */
+static void process_batch_message(const char *message, size_t length, IngestResult *result) {
+    BatchHeader header;
+    memcpy(&header, message, sizeof(header));
+    
+    if (header.count == 0 || header.count > BATCH_MAX_RECORDS ||
+        length != sizeof(BatchHeader) + (size_t)header.count * sizeof(BatchRecord)) {
+        write_log("ERRO: Frame binário no socket com tamanho inválido (%zu bytes, %u registos)",
+                 length, header.count);
+        result->rejected++;
+        return;
+    }
+    
+    admit_batch_records((const unsigned char *)message + sizeof(BatchHeader), 
+                        header.count, result);
+    
+    write_log("RECEÇÃO SOCKET: Frame binário com %u registos (%d adicionados, %d descartados, %d inválidos)",
+             header.count, result->accepted, result->dropped, result->rejected);
+}
+
+/*
+ * Trata uma mensagem do socket de ingestão
+ * Cada mensagem é um frame binário completo ou uma única linha de texto
+ */
+static void process_ingest_message(const char *message, size_t length, IngestResult *result) {
+    uint32_t magic = 0;
+    
+    if (length >= sizeof(BatchHeader)) {
+        memcpy(&magic, message, sizeof(magic));
+    }
+    
+    if (magic == BATCH_MAGIC) {
+        process_batch_message(message, length, result);
+        return;
+    }
+    
+    if (length >= PIPE_BUFFER_SIZE) {
+        write_log("ERRO: Linha no socket demasiado longa (%zu bytes)", length);
+        result->rejected++;
+        return;
+    }
+    
+    // Remover terminadores de linha
+    char line[PIPE_BUFFER_SIZE];
+    memcpy(line, message, length);
+    while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r')) {
+        length--;
+    }
+    line[length] = '\0';
+    
+    process_pipe_input(line, result);
+}
+
+/*
+ * Handler do socket de ingestão ('result' vem a zeros para cada mensagem)
+ */
+static void handle_ingest_message(const char *message, size_t length, IngestResult *result) {
+    process_ingest_message(message, length, result);
+    record_ingest(result);
+}
+
+/*
+ * Lê frames do named pipe binário (não-bloqueante)
+ * Os registos são processados à medida que chegam, mesmo que o frame
+ * ainda não esteja completo. É feito apenas um registo de log por leitura.
+ */
+void read_from_batch_pipe() {
+    static unsigned char buffer[BATCH_READ_SIZE];
+    static size_t buffer_len = 0;
+    static uint32_t records_remaining = 0;
+    
+    ssize_t bytes_read = read(batch_pipe_fd, buffer + buffer_len, 
+                              sizeof(buffer) - buffer_len);
+    
+    if (bytes_read == -1) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            write_log("ERRO: Falha ao ler do named pipe binário");
+        }
+        return;
+    }
+    
+    buffer_len += bytes_read;
+    
+    size_t pos = 0;
+    int frames = 0;
+    size_t skipped = 0;
+    IngestResult result = {0, 0, 0};
+    
+    while (1) {
+        if (records_remaining == 0) {
+            // À espera de um cabeçalho
+            if (buffer_len - pos < sizeof(BatchHeader)) {
+                break;
+            }
+            
+            BatchHeader header;
+            memcpy(&header, buffer + pos, sizeof(header));
+            
+            if (header.magic != BATCH_MAGIC) {
+                // Dados corrompidos: avançar um byte e procurar o próximo cabeçalho
+                pos++;
+                skipped++;
+                continue;
+            }
+            
+            pos += sizeof(header);
+            
+            if (header.count == 0 || header.count > BATCH_MAX_RECORDS) {
+                write_log("ERRO: Frame binário com número de registos inválido (%u)", 
+                         header.count);
+                continue;
+            }
+            
+            records_remaining = header.count;
+            frames++;
+        } else {
+            // Admitir de uma vez todos os registos completos já recebidos deste frame
+            size_t available = (buffer_len - pos) / sizeof(BatchRecord);
+            if (available == 0) {
+                break;
+            }
+            if (available > records_remaining) {
+                available = records_remaining;
+            }
+            
+            admit_batch_records(buffer + pos, available, &result);
+            pos += available * sizeof(BatchRecord);
+            records_remaining -= available;
+        }
+    }
+    
+    // Guardar bytes de um registo/cabeçalho incompleto para a próxima leitura
+    memmove(buffer, buffer + pos, buffer_len - pos);
+    buffer_len -= pos;
+    
+    if (skipped > 0) {
+        write_log("ERRO: %zu bytes inválidos ignorados no named pipe binário", skipped);
+    }
+    
+    record_ingest(&result);
+    
+    if (result.accepted > 0 || result.dropped > 0 || result.rejected > 0) {
+        write_log("RECEÇÃO BINÁRIA: %d frames, %d pacientes adicionados, %d descartados, %d inválidos",
+                 frames, result.accepted, result.dropped, result.rejected);
+    }
+}
+
+/*
+ * Liberta a fila de mensagens e a memória partilhada nos caminhos de erro
+ * do arranque: o coordenador destrói-as, um front-end só sai do registo
+ */
+static void release_shared_resources() {
+    if (frontend_id > 0) {
+        leave_coordinator(0);
+        return;
+    }
+    
+    destroy_message_queue();
+    destroy_shared_memory();
 }
 
 /*
  * Função principal do processo Admission
+ * Uso: ./admission [--recover] [--scale-out]
  */
-int main(void) {
+int main(int argc, char *argv[]) {
+    // --recover: retomar filas e estatísticas do último checkpoint
+    // --scale-out: com um coordenador já em execução, juntar-se como front-end
+    int recover = 0;
+    int scale_out = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--recover") == 0) {
+            recover = 1;
+        } else if (strcmp(argv[i], "--scale-out") == 0) {
+            scale_out = 1;
+        } else {
+            fprintf(stderr, "Uso: %s [--recover] [--scale-out]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    
     printf("=== Urgências@DEI - Sistema de Simulação ===\n");
     printf("Iniciando processo Admission (PID: %d)...\n", getpid());
     
     // Registar hora de início
     time_t start_time = time(NULL);
     
+    // 0. Contadores de contenção dos locks (só com make lockstat)
+    if (open_lockstat() != 0) {
+        fprintf(stderr, "AVISO: Contadores de contenção indisponíveis\n");
+    }
+    
+    // 0b. Eleição do coordenador: o primeiro Admission cria os recursos e os
+    // Doctors; com --scale-out os seguintes juntam-se como front-ends
+    int role = elect_coordinator();
+    if (role == -1) {
+        return EXIT_FAILURE;
+    }
+    if (role == 0) {
+        if (!scale_out) {
+            fprintf(stderr, "ERRO: Já existe um Admission em execução (use --scale-out para juntar um front-end)\n");
+            return EXIT_FAILURE;
+        }
+        if (join_coordinator(SCALEOUT_JOIN_TIMEOUT_MS) == -1) {
+            fprintf(stderr, "ERRO: Falha ao juntar ao coordenador\n");
+            return EXIT_FAILURE;
+        }
+        if (recover) {
+            fprintf(stderr, "AVISO: --recover ignorado num front-end\n");
+            recover = 0;
+        }
+    }
+    
     // 1. Criar ficheiro de log mapeado em memória 
     if (create_log_file() != 0) {
         fprintf(stderr, "ERRO: Falha ao criar ficheiro de log\n");
@@ -434,26 +861,55 @@ int main(void) {
     
     print_config(&global_config);
     
+    // Colocação NUMA: memória partilhada e log no nó da primeira CPU dos
+    // Doctors (ou da triagem, se só essa tiver afinidade)
+    CpuList numa_cpus;
+    parse_cpu_list(global_config.doctor_cpus, &numa_cpus);
+    if (numa_cpus.count == 0) {
+        parse_cpu_list(global_config.triage_cpus, &numa_cpus);
+    }
+    int numa_node = cpu_numa_node(cpu_list_pick(&numa_cpus, 0));
+    if (numa_node >= 0) {
+        write_log("Memória partilhada e log no nó NUMA %d", numa_node);
+        set_shared_memory_numa_node(numa_node);
+        bind_log_to_numa_node(numa_node);
+    }
+    
     // 3. Configurar handlers de sinais
     setup_signal_handlers();
     
-    // 4. Criar memória partilhada
-    write_log("A criar memória partilhada...");
-    
-    if (create_shared_memory() != 0) {
-        write_log("ERRO: Falha ao criar memória partilhada");
-        close_log_file();
-        return EXIT_FAILURE;
+    // 4. Criar memória partilhada (um front-end já está anexado à do coordenador,
+    // com a disciplina, os grupos e a configuração dos Doctors publicados por ele)
+    if (frontend_id > 0) {
+        write_log("Front-end %d ligado ao coordenador (PID: %d)", frontend_id,
+                  atomic_load(&shm_stats->coordinator_pid));
+    } else {
+        write_log("A criar memória partilhada...");
+        
+        if (create_shared_memory() != 0) {
+            write_log("ERRO: Falha ao criar memória partilhada");
+            close_log_file();
+            return EXIT_FAILURE;
+        }
+        
+        write_log("Memória partilhada criada com sucesso");
+        
+        // Disciplina da fila de atendimento (partilhada com triagem e Doctors)
+        set_queue_discipline(global_config.queue_discipline, global_config.sjf_max_wait_ms);
+        
+        // Grupos de Doctors (lanes da fila de atendimento)
+        publish_doctor_groups(&global_config);
+        
+        // Configuração versionada (os Doctors seguem os recarregamentos)
+        publish_config(&global_config);
     }
     
-    write_log("Memória partilhada criada com sucesso");
-    
     // 5. Criar named pipe
     write_log("A criar named pipe...");
     
     if (create_named_pipe() != 0) {
         write_log("ERRO: Falha ao criar named pipe");
-        destroy_shared_memory();
+        release_shared_resources();
         close_log_file();
         return EXIT_FAILURE;
     }
@@ -462,57 +918,130 @@ int main(void) {
     if (pipe_fd == -1) {
         write_log("ERRO: Falha ao abrir named pipe");
         destroy_named_pipe();
-        destroy_shared_memory();
+        release_shared_resources();
         close_log_file();
         return EXIT_FAILURE;
     }
     
-    write_log("Named pipe criado e aberto com sucesso");
+    if (create_batch_pipe() != 0 || (batch_pipe_fd = open_batch_pipe_read()) == -1) {
+        write_log("ERRO: Falha ao criar named pipe binário");
+        destroy_batch_pipe();
+        close_named_pipe(pipe_fd);
+        destroy_named_pipe();
+        release_shared_resources();
+        close_log_file();
+        return EXIT_FAILURE;
+    }
     
-    // 6. Criar fila de mensagens
-    write_log("A criar fila de mensagens...");
+    write_log("Named pipe criado e aberto com sucesso");
     
-    if (create_message_queue() != 0) {
-        write_log("ERRO: Falha ao criar fila de mensagens");
+    // 5b. Criar socket de ingestão (vários produtores com ACK)
+    if (create_ingest_socket() != 0) {
+        write_log("ERRO: Falha ao criar socket de ingestão");
+        close_named_pipe(batch_pipe_fd);
+        destroy_batch_pipe();
         close_named_pipe(pipe_fd);
         destroy_named_pipe();
-        destroy_shared_memory();
+        release_shared_resources();
         close_log_file();
         return EXIT_FAILURE;
     }
     
-    write_log("Fila de mensagens criada com sucesso (ID: %d)", msq_id);
+    write_log("Socket de ingestão criado (%s)", get_ingest_socket_name());
+    
+    // 6. Criar fila de mensagens (um front-end usa a do coordenador)
+    if (frontend_id == 0) {
+        write_log("A criar fila de mensagens...");
+        
+        if (create_message_queue() != 0) {
+            write_log("ERRO: Falha ao criar fila de mensagens");
+            destroy_ingest_socket();
+            close_named_pipe(batch_pipe_fd);
+            destroy_batch_pipe();
+            close_named_pipe(pipe_fd);
+            destroy_named_pipe();
+            release_shared_resources();
+            close_log_file();
+            return EXIT_FAILURE;
+        }
+        
+        write_log("Fila de mensagens criada com sucesso (ID: %d)", msq_id);
+        
+        // 6b. Rasto por paciente e linha temporal (herdados pelos Doctors no fork)
+        if (global_config.patient_trace_max > 0 && open_trace(global_config.patient_trace_max) != 0) {
+            write_log("AVISO: Rasto por paciente indisponível");
+        }
+        if (global_config.timeline_max_events > 0 && open_timeline(global_config.timeline_max_events) != 0) {
+            write_log("AVISO: Linha temporal indisponível");
+        }
+    } else {
+        write_log("Fila de mensagens do coordenador (ID: %d)", msq_id);
+    }
     
     // 7. Criar threads de triagem
     write_log("A criar %d threads de triagem...", global_config.triage);
     
     if (create_triage_threads(global_config.triage, &global_config) != 0) {
         write_log("ERRO: Falha ao criar threads de triagem");
-        destroy_message_queue();
+        destroy_ingest_socket();
+        close_named_pipe(batch_pipe_fd);
+        destroy_batch_pipe();
         close_named_pipe(pipe_fd);
         destroy_named_pipe();
-        destroy_shared_memory();
+        release_shared_resources();
         close_log_file();
         return EXIT_FAILURE;
     }
     
     write_log("%d threads de triagem criadas com sucesso", global_config.triage);
     
-    // 8. Criar processos Doctor
-    write_log("A criar %d processos Doctor...", global_config.doctors);
+    // 8. Criar processos Doctor (só o coordenador)
+    if (frontend_id == 0) {
+        write_log("A criar %d processos Doctor...", global_config.doctors);
+    }
     
-    if (create_all_doctors(&global_config) != 0) {
+    if (frontend_id == 0 && create_all_doctors(&global_config) != 0) {
         write_log("ERRO: Falha ao criar processos Doctor");
         terminate_triage_threads();
-        destroy_message_queue();
+        destroy_ingest_socket();
+        close_named_pipe(batch_pipe_fd);
+        destroy_batch_pipe();
         close_named_pipe(pipe_fd);
         destroy_named_pipe();
-        destroy_shared_memory();
+        release_shared_resources();
         close_log_file();
         return EXIT_FAILURE;
     }
     
-    write_log("%d processos Doctor criados com sucesso", global_config.doctors);
+    if (frontend_id == 0) {
+        write_log("%d processos Doctor criados com sucesso", global_config.doctors);
+    }
+    
+    // 8b. Checkpoint (e recuperação com --recover), só no coordenador
+    if (frontend_id == 0 && (global_config.checkpoint_interval_ms > 0 || recover)) {
+        if (open_checkpoint(recover) != 0) {
+            write_log("AVISO: Checkpoint indisponível");
+        } else if (recover) {
+            int restored = restore_checkpoint(&patient_counter);
+            if (restored < 0) {
+                write_log("AVISO: --recover sem checkpoint válido, a começar do zero");
+            } else {
+                atomic_store(&shm_stats->arrival_counter, patient_counter);
+                printf("Recuperados %d pacientes do checkpoint\n", restored);
+            }
+        }
+    }
+    
+    // Coordenador pronto: a partir daqui os front-ends podem juntar-se
+    if (frontend_id == 0) {
+        announce_coordinator();
+    }
+    
+    // 8c. Recarregamento a quente: alterações a config.txt (além do SIGHUP)
+    int config_watch_fd = open_config_watch("config.txt");
+    if (config_watch_fd == -1) {
+        write_log("AVISO: inotify indisponível, config.txt só é recarregado com SIGHUP");
+    }
     
     // 9. Loop principal
     write_log("=== SISTEMA PRONTO ===");
@@ -524,70 +1053,196 @@ int main(void) {
     printf("║ Para enviar pacientes, use:                               ║\n");
     printf("║   echo \"João 10 50 1\" > input_pipe                        ║\n");
     printf("║   echo \"5 20 100 2\" > input_pipe                          ║\n");
+    printf("║ Ou via socket SOCK_SEQPACKET (com ACK):                   ║\n");
+    printf("║   %-54s  ║\n", get_ingest_socket_name());
     printf("║                                                            ║\n");
     printf("║ Comandos:                                                  ║\n");
     printf("║   kill -SIGUSR1 %d  -> Ver estatísticas               ║\n", getpid());
+    printf("║   kill -SIGHUP %d   -> Recarregar config.txt          ║\n", getpid());
     printf("║   Ctrl+C              -> Terminar sistema                 ║\n");
     printf("╚════════════════════════════════════════════════════════════╝\n\n");
     
+    if (frontend_id > 0) {
+        char name[INSTANCE_NAME_MAX];
+        instance_name(PIPE_NAME, name, sizeof(name));
+        printf("Front-end %d do coordenador (PID: %d): named pipe %s\n\n", frontend_id,
+               atomic_load(&shm_stats->coordinator_pid), name);
+    }
+    
     // Loop principal com select para leitura não-bloqueante
     fd_set read_fds;
     struct timeval timeout;
-    int check_counter = 0; // Contador para verificar fila periodicamente
+    int ingest_fd = get_ingest_poll_fd();
     
     while (keep_running) {
         FD_ZERO(&read_fds);
         FD_SET(pipe_fd, &read_fds);
+        FD_SET(batch_pipe_fd, &read_fds);
+        FD_SET(ingest_fd, &read_fds);
+        int max_fd = (pipe_fd > batch_pipe_fd) ? pipe_fd : batch_pipe_fd;
+        if (ingest_fd > max_fd) {
+            max_fd = ingest_fd;
+        }
+        if (config_watch_fd != -1) {
+            FD_SET(config_watch_fd, &read_fds);
+            if (config_watch_fd > max_fd) {
+                max_fd = config_watch_fd;
+            }
+        }
         
         timeout.tv_sec = 1;
         timeout.tv_usec = 0;
         
-        int ready = select(pipe_fd + 1, &read_fds, NULL, NULL, &timeout);
+        int ready = select(max_fd + 1, &read_fds, NULL, NULL, &timeout);
         
-        if (ready > 0 && FD_ISSET(pipe_fd, &read_fds)) {
-            read_from_pipe();
+        if (ready > 0) {
+            if (FD_ISSET(pipe_fd, &read_fds)) {
+                read_from_pipe();
+            }
+            if (FD_ISSET(batch_pipe_fd, &read_fds)) {
+                read_from_batch_pipe();
+            }
+            if (FD_ISSET(ingest_fd, &read_fds)) {
+                process_ingest_events(handle_ingest_message);
+            }
+            if (config_watch_fd != -1 && FD_ISSET(config_watch_fd, &read_fds) &&
+                config_watch_changed(config_watch_fd)) {
+                reload_requested = 1;
+            }
         } else if (ready == -1 && errno != EINTR) {
             write_log("ERRO: Falha no select");
             break;
         }
-        // Verificar periodicamente se é necessário criar doctor temporário
-        check_counter++;
-        if (check_counter >= 5) { // A cada 5 segundos
-            check_and_create_temporary_doctor(&global_config);
-            check_counter = 0;
+        // Trabalho pedido pelos handlers de SIGCHLD, SIGHUP e SIGUSR1
+        if (child_exited) {
+            reap_children();
         }
+        if (stats_requested) {
+            show_statistics();
+        }
+        if (reload_requested && keep_running) {
+            reload_requested = 0;
+            reload_config("config.txt", &global_config);
+        }
+        
+        // Front-end: sem coordenador não há Doctors nem fila de atendimento
+        if (frontend_id > 0) {
+            if (!coordinator_alive()) {
+                write_log("ERRO: O coordenador terminou, a terminar o front-end %d", frontend_id);
+                keep_running = 0;
+            }
+            continue;
+        }
+        
+        // Controlador de pico (amostra a cada SURGE_INTERVAL_MS)
+        adjust_temporary_doctors(&global_config);
+        
+        // Checkpoint periódico (a cada CHECKPOINT_INTERVAL_MS), com o
+        // contador partilhado (inclui os números dados pelos front-ends)
+        checkpoint_tick(&global_config, atomic_load(&shm_stats->arrival_counter));
     }
     
     // 10. Terminação controlada
     write_log("=== TERMINAÇÃO CONTROLADA ===");
+    close_config_watch(config_watch_fd);
     
-    // Mostrar estatísticas finais
-    printf("\n=== ESTATÍSTICAS FINAIS ===\n");
-    write_log("Estatísticas finais:");
-    print_statistics();
+    // Coordenador: não aceitar mais front-ends e pedir aos atuais que
+    // escoem a sua triagem (a drenagem abaixo espera por eles)
+    if (frontend_id == 0) {
+        retire_coordinator();
+        signal_frontends();
+    }
     
-    int queue_size = get_queue_size();
-    if (queue_size >= 0) {
-        write_log("Pacientes na fila de atendimento: %d", queue_size);
+    // Fechar a entrada de pacientes antes de escoar as filas
+    write_log("A fechar named pipes e socket de ingestão...");
+    destroy_ingest_socket();
+    close_named_pipe(batch_pipe_fd);
+    destroy_batch_pipe();
+    close_named_pipe(pipe_fd);
+    destroy_named_pipe();
+    
+    // Deixar triagem e Doctors atenderem os pacientes já aceites
+    // (um front-end sem coordenador já não tem para onde os enviar)
+    if (frontend_id == 0 || coordinator_alive()) {
+        drain_patients();
+    }
+    
+    // Último checkpoint: os pacientes que não foram atendidos ficam nele
+    // e podem ser retomados com --recover
+    if (frontend_id == 0) {
+        save_checkpoint(atomic_load(&shm_stats->arrival_counter));
+        close_checkpoint();
+    }
+    
+    // Total de pacientes aceites (a entrada já está fechada)
+    long accepted = 0;
+    if (triage_queue != NULL) {
+        pthread_mutex_lock(&triage_queue->mutex);
+        accepted = triage_queue->total_enqueued;
+        pthread_mutex_unlock(&triage_queue->mutex);
     }
     
     // Terminar threads de triagem
     write_log("A terminar threads de triagem...");
     terminate_triage_threads();
     
+    // Front-end: os aceites somam-se ao total do coordenador; a memória
+    // partilhada e a MSQ ficam para ele destruir
+    if (frontend_id > 0) {
+        printf("\nFront-end %d: %ld pacientes aceites\n", frontend_id, accepted);
+        write_log("Front-end %d: %ld pacientes aceites", frontend_id, accepted);
+        print_lockstat();
+        leave_coordinator(accepted);
+        
+        write_log("=== FIM DO PROGRAMA ===");
+        write_log("Tempo total de execução: %.0f segundos", difftime(time(NULL), start_time));
+        close_log_file();
+        
+        return EXIT_SUCCESS;
+    }
+    
+    // Pacientes aceites pelos front-ends (a drenagem esperou por eles)
+    wait_frontends(SCALEOUT_STOP_GRACE_MS);
+    accepted += get_frontend_accepted();
+    
     // Terminar todos os processos Doctor
     write_log("A terminar processos Doctor...");
     terminate_all_doctors();
     
+    // Mostrar estatísticas finais (já sem Doctors a atualizá-las)
+    printf("\n=== ESTATÍSTICAS FINAIS ===\n");
+    write_log("Estatísticas finais:");
+    print_statistics();
+    
+    int triaged, attended;
+    get_stats_counters(&triaged, &attended);
+    int queue_size = get_queue_size();
+    long abandoned = accepted - attended;
+    printf("Pacientes aceites: %ld | concluídos: %d | abandonados: %ld (%d na fila de atendimento)\n",
+           accepted, attended, abandoned, queue_size);
+    write_log("Pacientes aceites: %ld, concluídos: %d, abandonados: %ld (%d na fila de atendimento)",
+              accepted, attended, abandoned, queue_size);
+    
+    // Tempo de CPU do Admission e dos Doctors (todos já terminados e recolhidos)
+    struct rusage self_usage, children_usage;
+    getrusage(RUSAGE_SELF, &self_usage);
+    getrusage(RUSAGE_CHILDREN, &children_usage);
+    double cpu_user = self_usage.ru_utime.tv_sec + self_usage.ru_utime.tv_usec / 1e6 +
+                      children_usage.ru_utime.tv_sec + children_usage.ru_utime.tv_usec / 1e6;
+    double cpu_system = self_usage.ru_stime.tv_sec + self_usage.ru_stime.tv_usec / 1e6 +
+                        children_usage.ru_stime.tv_sec + children_usage.ru_stime.tv_usec / 1e6;
+    printf("Tempo de CPU (Admission + Doctors): utilizador %.3f s | sistema %.3f s\n\n",
+           cpu_user, cpu_system);
+    print_lockstat();
+    
+    // Fechar o rasto e a linha temporal (já sem triagem nem Doctors a escrever)
+    close_trace();
+    close_timeline();
+    
     // Destruir fila de mensagens
     write_log("A destruir fila de mensagens...");
     destroy_message_queue();
     
-    // Fechar e destruir named pipe
-    write_log("A fechar named pipe...");
-    close_named_pipe(pipe_fd);
-    destroy_named_pipe();
-    
     // Destruir memória partilhada
     write_log("A destruir memória partilhada...");
     destroy_shared_memory();
@@ -0,0 +1,215 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ */
+
+#define _GNU_SOURCE // Para CPU_SET, sched_setaffinity e pthread_attr_setaffinity_np
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sched.h>
+#include <dirent.h>
+#include <sys/syscall.h>
+#include "affinity.h"
+
+#define DEBUG 
+
+/* Constantes de mbind(2) (evita depender da libnuma) */
+#define AFFINITY_MPOL_PREFERRED 1
+#define AFFINITY_MPOL_MF_MOVE (1 << 1)
+
+/*
+ * Interpreta uma especificação de CPUs:
+ *   ""/"none" -> sem afinidade
+ *   "rr"/"all" -> todas as CPUs online (round-robin)
+ *   "0-3,8,10-11" -> lista explícita
+ * Retorna 0 em caso de sucesso, -1 se a especificação é inválida
+ */
+int parse_cpu_list(const char *spec, CpuList *list) {
+    list->count = 0;
+    
+    if (spec == NULL || spec[0] == '\0' || strcmp(spec, "none") == 0) {
+        return 0;
+    }
+    
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    if (online < 1) {
+        online = 1;
+    }
+    
+    if (strcmp(spec, "rr") == 0 || strcmp(spec, "all") == 0) {
+        for (int cpu = 0; cpu < online && cpu < AFFINITY_MAX_CPUS; cpu++) {
+            list->cpus[list->count++] = cpu;
+        }
+        return 0;
+    }
+    
+    const char *p = spec;
+    while (*p != '\0') {
+        char *end;
+        long first = strtol(p, &end, 10);
+        if (end == p || first < 0) {
+            fprintf(stderr, "ERRO: Lista de CPUs inválida '%s'\n", spec);
+            list->count = 0;
+            return -1;
+        }
+        
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            p++;
+            last = strtol(p, &end, 10);
+            if (end == p || last < first) {
+                fprintf(stderr, "ERRO: Intervalo de CPUs inválido em '%s'\n", spec);
+                list->count = 0;
+                return -1;
+            }
+            p = end;
+        }
+        
+        for (long cpu = first; cpu <= last && list->count < AFFINITY_MAX_CPUS; cpu++) {
+            list->cpus[list->count++] = (int)cpu;
+        }
+        
+        if (*p == ',') {
+            p++;
+        } else if (*p != '\0') {
+            fprintf(stderr, "ERRO: Carácter inesperado '%c' na lista de CPUs '%s'\n", *p, spec);
+            list->count = 0;
+            return -1;
+        }
+    }
+    
+    // Uma CPU fora das permitidas ao processo faria falhar o pthread_create (EINVAL)
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        for (int i = 0; i < list->count; i++) {
+            if (list->cpus[i] >= CPU_SETSIZE || !CPU_ISSET(list->cpus[i], &allowed)) {
+                fprintf(stderr, "ERRO: CPU %d de '%s' não está online/disponível\n", list->cpus[i], spec);
+                list->count = 0;
+                return -1;
+            }
+        }
+    }
+    
+    return 0;
+}
+
+/*
+ * Devolve a CPU atribuída ao índice 'index' (round-robin), ou -1 sem afinidade
+ */
+int cpu_list_pick(const CpuList *list, int index) {
+    if (list->count == 0 || index < 0) {
+        return -1;
+    }
+    return list->cpus[index % list->count];
+}
+
+/*
+ * Configura os atributos de uma thread para correr apenas na CPU 'cpu'
+ * Retorna 0 em caso de sucesso, -1 em caso de erro
+ */
+int set_thread_attr_cpu(pthread_attr_t *attr, int cpu) {
+    if (cpu < 0) {
+        return 0;
+    }
+    
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    
+    if (pthread_attr_setaffinity_np(attr, sizeof(set), &set) != 0) {
+        fprintf(stderr, "AVISO: Falha ao definir afinidade para a CPU %d\n", cpu);
+        return -1;
+    }
+    
+    return 0;
+}
+
+/*
+ * Fixa um processo (0 = o próprio) na CPU 'cpu'
+ * Retorna 0 em caso de sucesso, -1 em caso de erro
+ */
+int pin_process_to_cpu(pid_t pid, int cpu) {
+    if (cpu < 0) {
+        return 0;
+    }
+    
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    
+    if (sched_setaffinity(pid, sizeof(set), &set) == -1) {
+        perror("Aviso: Erro ao fixar processo numa CPU (sched_setaffinity)");
+        return -1;
+    }
+    
+    return 0;
+}
+
+/*
+ * Devolve o nó NUMA de uma CPU (lido de /sys), ou -1 se não for possível
+ */
+int cpu_numa_node(int cpu) {
+    if (cpu < 0) {
+        return -1;
+    }
+    
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+    
+    DIR *dir = opendir(path);
+    if (dir == NULL) {
+        return -1;
+    }
+    
+    int node = -1;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strncmp(entry->d_name, "node", 4) == 0 && 
+            sscanf(entry->d_name + 4, "%d", &node) == 1) {
+            break;
+        }
+    }
+    
+    closedir(dir);
+    return node;
+}
+
+/*
+ * Define o nó NUMA preferido para uma região mapeada (alinhada à página)
+ * Com 'move_pages', as páginas já tocadas são migradas para esse nó
+ * Retorna 0 em caso de sucesso, -1 em caso de erro
+ */
+int bind_memory_to_node(void *addr, size_t length, int node, int move_pages) {
+    if (node < 0) {
+        return 0;
+    }
+    
+    unsigned long nodemask[AFFINITY_MAX_CPUS / (8 * sizeof(unsigned long))];
+    memset(nodemask, 0, sizeof(nodemask));
+    
+    if (node >= (int)(8 * sizeof(nodemask))) {
+        return -1;
+    }
+    nodemask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+    
+    long result = syscall(SYS_mbind, addr, length, AFFINITY_MPOL_PREFERRED, nodemask,
+                          8 * sizeof(nodemask), move_pages ? AFFINITY_MPOL_MF_MOVE : 0);
+    if (result == -1) {
+        #ifdef DEBUG
+        printf("[DEBUG] mbind para o nó %d falhou: %s\n", node, strerror(errno));
+        #endif
+        return -1;
+    }
+    
+    #ifdef DEBUG
+    printf("[DEBUG] Região %p (%zu bytes) associada ao nó NUMA %d\n", addr, length, node);
+    #endif
+    
+    return 0;
+}
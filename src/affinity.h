@@ -0,0 +1,34 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ */
+
+#ifndef AFFINITY_H
+#define AFFINITY_H
+
+#include <stddef.h>
+#include <sys/types.h>
+#include <pthread.h>
+
+#define AFFINITY_MAX_CPUS 1024
+#define AFFINITY_SPEC_SIZE 128
+
+/* Lista de CPUs pelas quais as threads/processos são distribuídos (round-robin) */
+typedef struct {
+    int cpus[AFFINITY_MAX_CPUS];
+    int count;                   // 0 = sem afinidade
+} CpuList;
+
+/* Funções para afinidade de CPU */
+int parse_cpu_list(const char *spec, CpuList *list);
+int cpu_list_pick(const CpuList *list, int index);
+int set_thread_attr_cpu(pthread_attr_t *attr, int cpu);
+int pin_process_to_cpu(pid_t pid, int cpu);
+
+/* Funções para NUMA */
+int cpu_numa_node(int cpu);
+int bind_memory_to_node(void *addr, size_t length, int node, int move_pages);
+
+#endif // AFFINITY_H
@@ -0,0 +1,193 @@
+#!/bin/bash
+#
+# Sistemas Operativos 2025/2026
+# Projeto: Urgências@DEI
+#
+# Benchmark ponta-a-ponta (make bench): arranca o Admission com variantes de
+# config.txt (varrimentos de TRIAGE, DOCTORS e MSQ_WAIT_MAX, um parâmetro de
+# cada vez sobre a config.txt base), envia sempre a mesma carga com o loadgen
+# e acrescenta uma linha por execução a $BENCH_CSV
+#
+# Variáveis (ambiente ou make bench VAR=...):
+#   BENCH_CSV        ficheiro de resultados (omissão: bench.csv)
+#   BENCH_PATIENTS   pacientes por execução (omissão: 5000)
+#   BENCH_RATE       chegadas Poisson por segundo (omissão: 5000)
+#   BENCH_TRIAGE_MS  tempo de triagem do loadgen (omissão: const:1)
+#   BENCH_ATTEND_MS  tempo de atendimento do loadgen (omissão: const:1)
+#   BENCH_SEED       semente do loadgen (omissão: 1)
+#   BENCH_TRIAGE     valores de TRIAGE a testar (omissão: "1 2 4 8")
+#   BENCH_DOCTORS    valores de DOCTORS a testar (omissão: "1 2 4 8")
+#   BENCH_MSQ        valores de MSQ_WAIT_MAX a testar (omissão: "10 100 1000")
+#   BENCH_TIMEOUT    segundos máximos por execução (omissão: 300)
+#   BENCH_WARM       valor fixo de WARM_DOCTORS em todas as execuções (omissão: 0)
+#
+# O checkpoint periódico fica sempre desligado (CHECKPOINT_INTERVAL_MS = 0)
+#
+
+SRC_DIR=$(cd "$(dirname "$0")" && pwd)
+ADMISSION="$SRC_DIR/admission"
+LOADGEN="$SRC_DIR/loadgen"
+SOCKET=/tmp/urgencias.sock
+
+BENCH_CSV=${BENCH_CSV:-bench.csv}
+BENCH_PATIENTS=${BENCH_PATIENTS:-5000}
+BENCH_RATE=${BENCH_RATE:-5000}
+BENCH_TRIAGE_MS=${BENCH_TRIAGE_MS:-const:1}
+BENCH_ATTEND_MS=${BENCH_ATTEND_MS:-const:1}
+BENCH_SEED=${BENCH_SEED:-1}
+BENCH_TRIAGE=${BENCH_TRIAGE:-"1 2 4 8"}
+BENCH_DOCTORS=${BENCH_DOCTORS:-"1 2 4 8"}
+BENCH_MSQ=${BENCH_MSQ:-"10 100 1000"}
+BENCH_TIMEOUT=${BENCH_TIMEOUT:-300}
+BENCH_WARM=${BENCH_WARM:-0}
+
+COMMIT=$(git -C "$SRC_DIR" rev-parse --short HEAD 2>/dev/null || echo "-")
+if ! git -C "$SRC_DIR" diff --quiet HEAD 2>/dev/null; then
+    COMMIT="$COMMIT+"
+fi
+
+if [ ! -x "$ADMISSION" ] || [ ! -x "$LOADGEN" ]; then
+    echo "ERRO: Compile primeiro (make all)" >&2
+    exit 1
+fi
+
+if pgrep -x admission > /dev/null; then
+    echo "ERRO: Já existe um Admission a correr (os nomes de IPC são fixos)" >&2
+    exit 1
+fi
+
+if [ ! -f "$BENCH_CSV" ]; then
+    echo "timestamp,commit,sweep,triage,doctors,msq_wait_max,patients,rate,accepted,dropped,triaged,attended,elapsed_s,triage_per_s,doctor_per_s,p50_ms,p99_ms,cpu_s,cpu_us_per_patient,drop_rate" > "$BENCH_CSV"
+fi
+
+# Valor de uma chave de config.txt
+config_value() {
+    sed -n "s/^$1[[:space:]]*=[[:space:]]*\([^[:space:]]*\).*/\1/p" "$SRC_DIR/config.txt" | head -1
+}
+
+# Segundos com casas decimais (CLOCK_REALTIME; suficiente para execuções de segundos)
+now() {
+    date +%s.%N
+}
+
+# Número de uma linha "... : N ║" das estatísticas finais
+stat_number() {
+    grep -a "$1" "$2" | tail -1 | awk -F: '{print $2}' | tr -dc '0-9'
+}
+
+# Uma execução: run <varrimento> <TRIAGE> <DOCTORS> <MSQ_WAIT_MAX>
+run() {
+    local sweep=$1 triage=$2 doctors=$3 msq=$4
+    local dir
+    dir=$(mktemp -d /tmp/urgencias-bench.XXXXXX)
+
+    # Chaves opcionais: apagar a linha da base e acrescentar o valor fixo no fim
+    sed -e "s/^TRIAGE[[:space:]]*=.*/TRIAGE = $triage/" \
+        -e "s/^DOCTORS[[:space:]]*=.*/DOCTORS = $doctors/" \
+        -e "s/^MSQ_WAIT_MAX[[:space:]]*=.*/MSQ_WAIT_MAX = $msq/" \
+        -e "s/^DOCTOR_GROUPS[[:space:]]*=.*/DOCTOR_GROUPS = none/" \
+        -e "s/^DRAIN_TIMEOUT_MS[[:space:]]*=.*/DRAIN_TIMEOUT_MS = $((BENCH_TIMEOUT * 1000))/" \
+        -e "/^WARM_DOCTORS[[:space:]]*=/d" \
+        -e "/^CHECKPOINT_INTERVAL_MS[[:space:]]*=/d" \
+        "$SRC_DIR/config.txt" > "$dir/config.txt"
+    printf "WARM_DOCTORS = %d\nCHECKPOINT_INTERVAL_MS = 0\n" "$BENCH_WARM" >> "$dir/config.txt"
+
+    rm -f "$SOCKET"
+    (cd "$dir" && exec "$ADMISSION" > admission.out 2>&1) &
+    local pid=$!
+
+    # Esperar pelo socket de ingestão (criado depois da SHM, MSQ e Doctors)
+    local tries=0
+    while [ ! -S "$SOCKET" ] && [ $tries -lt 100 ]; do
+        sleep 0.05
+        tries=$((tries + 1))
+    done
+    if [ ! -S "$SOCKET" ]; then
+        echo "ERRO: Admission não arrancou (ver $dir/admission.out)" >&2
+        kill -9 $pid 2>/dev/null
+        wait $pid 2>/dev/null
+        return 1
+    fi
+
+    local start end
+    start=$(now)
+    "$LOADGEN" -t socket -a poisson -r "$BENCH_RATE" -n "$BENCH_PATIENTS" -d 86400 \
+        -T "$BENCH_TRIAGE_MS" -A "$BENCH_ATTEND_MS" -S "$BENCH_SEED" > "$dir/loadgen.out" 2>&1
+
+    # SIGINT: o Admission drena as filas antes de terminar
+    kill -INT $pid
+    local waited=0
+    while kill -0 $pid 2>/dev/null && [ $waited -lt $((BENCH_TIMEOUT * 10)) ]; do
+        sleep 0.1
+        waited=$((waited + 1))
+    done
+    if kill -0 $pid 2>/dev/null; then
+        echo "ERRO: Admission não terminou em ${BENCH_TIMEOUT}s (ver $dir)" >&2
+        kill -9 $pid 2>/dev/null
+        wait $pid 2>/dev/null
+        return 1
+    fi
+    wait $pid 2>/dev/null
+    end=$(now)
+
+    local out="$dir/admission.out"
+    local accepted dropped triaged attended p50 p99 cpu_user cpu_system
+    # Aceites contados pelo Admission (os ACKs em falta no loadgen não contam);
+    # descartados = enviados que nunca entraram na triagem
+    accepted=$(grep -a "^Pacientes aceites:" "$out" | awk '{print $3}')
+    dropped=$((BENCH_PATIENTS - ${accepted:-0}))
+    triaged=$(stat_number "pacientes triados:" "$out")
+    attended=$(stat_number "pacientes atendidos:" "$out")
+    p50=$(grep -a "p50 / p99:" "$out" | tail -1 | awk -F: '{print $2}' | awk '{print ($1 == "N/A") ? "" : $1}')
+    p99=$(grep -a "p50 / p99:" "$out" | tail -1 | awk -F: '{print $2}' | awk '{print ($1 == "N/A") ? "" : $3}')
+    cpu_user=$(grep -a "^Tempo de CPU" "$out" | awk '{print $8}')
+    cpu_system=$(grep -a "^Tempo de CPU" "$out" | awk '{print $12}')
+
+    # Triagem/s e Doctors/s: triados e atendidos sobre o tempo total, drenagem
+    # incluída (os triados contam também os que saíram da fila durante a drenagem)
+    awk -v ts="$(date +%Y-%m-%dT%H:%M:%S)" -v commit="$COMMIT" -v sweep="$sweep" \
+        -v triage="$triage" -v doctors="$doctors" -v msq="$msq" \
+        -v patients="$BENCH_PATIENTS" -v rate="$BENCH_RATE" \
+        -v accepted="${accepted:-0}" -v dropped="${dropped:-0}" \
+        -v triaged="${triaged:-0}" -v attended="${attended:-0}" \
+        -v start="$start" -v end="$end" \
+        -v p50="$p50" -v p99="$p99" -v cpu_user="${cpu_user:-0}" -v cpu_system="${cpu_system:-0}" \
+        'BEGIN {
+            elapsed = end - start
+            cpu = cpu_user + cpu_system
+            printf "%s,%s,%s,%d,%d,%d,%d,%d,%d,%d,%d,%d,%.3f,%.1f,%.1f,%s,%s,%.3f,%.1f,%.4f\n",
+                   ts, commit, sweep, triage, doctors, msq, patients, rate,
+                   accepted, dropped, triaged, attended, elapsed,
+                   (elapsed > 0) ? triaged / elapsed : 0,
+                   (elapsed > 0) ? attended / elapsed : 0,
+                   p50, p99, cpu,
+                   (attended > 0) ? cpu / attended * 1e6 : 0,
+                   (patients > 0) ? dropped / patients : 0
+        }' | tee -a "$BENCH_CSV"
+
+    rm -rf "$dir"
+    return 0
+}
+
+BASE_TRIAGE=$(config_value TRIAGE)
+BASE_DOCTORS=$(config_value DOCTORS)
+BASE_MSQ=$(config_value MSQ_WAIT_MAX)
+
+echo "Benchmark: $BENCH_PATIENTS pacientes a ${BENCH_RATE}/s por execução (base: TRIAGE=$BASE_TRIAGE," \
+     "DOCTORS=$BASE_DOCTORS, MSQ_WAIT_MAX=$BASE_MSQ) -> $BENCH_CSV"
+
+failed=0
+for value in $BENCH_TRIAGE; do
+    run triage "$value" "$BASE_DOCTORS" "$BASE_MSQ" || failed=$((failed + 1))
+done
+for value in $BENCH_DOCTORS; do
+    run doctors "$BASE_TRIAGE" "$value" "$BASE_MSQ" || failed=$((failed + 1))
+done
+for value in $BENCH_MSQ; do
+    run msq_wait_max "$BASE_TRIAGE" "$BASE_DOCTORS" "$value" || failed=$((failed + 1))
+done
+
+if [ $failed -gt 0 ]; then
+    echo "ERRO: $failed execução(ões) falharam" >&2
+    exit 1
+fi
@@ -0,0 +1,112 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ *
+ * Micro-benchmark do log mapeado em memória: write_log com K threads
+ * (o ficheiro é criado numa diretoria temporária, não no DEI_Emergency.log)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "microbench.h"
+#include "log.h"
+
+#define BENCH_LOG_LINE_ESTIMATE 64      // Bytes por linha (com timestamp)
+
+typedef struct {
+    int id;
+    long ops;
+    pthread_barrier_t *start;
+} LogWorker;
+
+static void* log_writer(void *arg) {
+    LogWorker *worker = (LogWorker *)arg;
+    
+    pthread_barrier_wait(worker->start);
+    for (long i = 0; i < worker->ops; i++) {
+        write_log("Microbench: thread %d, mensagem %ld", worker->id, i);
+    }
+    return NULL;
+}
+
+/*
+ * Uma configuração: log novo, 'ops' linhas repartidas por 'threads'
+ * Retorna o tempo de parede em ns, ou -1 em caso de erro
+ */
+static long long run_log(long ops, int threads) {
+    if (create_log_file() != 0) {
+        return -1;
+    }
+    
+    pthread_barrier_t start;
+    pthread_barrier_init(&start, NULL, threads + 1);
+    
+    pthread_t ids[MICROBENCH_MAX_THREADS];
+    LogWorker workers[MICROBENCH_MAX_THREADS];
+    
+    for (int i = 0; i < threads; i++) {
+        workers[i].id = i + 1;
+        workers[i].ops = ops / threads + (i < ops % threads ? 1 : 0);
+        workers[i].start = &start;
+        pthread_create(&ids[i], NULL, log_writer, &workers[i]);
+    }
+    
+    pthread_barrier_wait(&start);
+    long long begin = bench_now_ns();
+    for (int i = 0; i < threads; i++) {
+        pthread_join(ids[i], NULL);
+    }
+    long long elapsed = bench_now_ns() - begin;
+    
+    pthread_barrier_destroy(&start);
+    close_log_file();
+    unlink(LOG_FILENAME);
+    
+    return elapsed;
+}
+
+int main(int argc, char *argv[]) {
+    long ops;
+    int max_workers;
+    
+    if (bench_init(argc, argv, &ops, &max_workers) != 0) {
+        return EXIT_FAILURE;
+    }
+    
+    // O log não é remapeado: acima disto as linhas seriam descartadas
+    long max_ops = LOG_FILE_SIZE / BENCH_LOG_LINE_ESTIMATE;
+    if (ops > max_ops) {
+        fprintf(bench_out, "Operações limitadas a %ld (LOG_FILE_SIZE)\n", max_ops);
+        ops = max_ops;
+    }
+    
+    char dir[] = "/tmp/urgencias-microbench.XXXXXX";
+    if (mkdtemp(dir) == NULL || chdir(dir) == -1) {
+        perror("Erro ao criar diretoria temporária");
+        return EXIT_FAILURE;
+    }
+    
+    bench_header("Log: write_log", "threads");
+    
+    for (int threads = 1; threads > 0; threads = bench_next_workers(threads, max_workers)) {
+        long long elapsed = run_log(ops, threads);
+        if (elapsed < 0) {
+            break;
+        }
+        
+        char label[32];
+        snprintf(label, sizeof(label), "%d", threads);
+        bench_row(label, ops, elapsed);
+    }
+    
+    if (chdir("/") == 0) {
+        rmdir(dir);
+    }
+    
+    return EXIT_SUCCESS;
+}
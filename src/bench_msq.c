@@ -0,0 +1,119 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ *
+ * Micro-benchmark da fila de atendimento: idas e voltas
+ * send_patient_to_queue + receive_patient_from_queue em K processos
+ * (com os contadores de lane na memória partilhada, como no Admission)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "microbench.h"
+#include "config.h"
+#include "shm.h"
+#include "msq.h"
+#include "group.h"
+
+/*
+ * Um processo: 'ops' idas e voltas, depois de o pai fechar o pipe de arranque
+ * Outro processo pode levar a mensagem enviada, por isso a receção repete
+ * até obter uma (como um Doctor em espera ativa)
+ */
+static void msq_worker(int start_fd, long ops) {
+    char go;
+    read(start_fd, &go, 1);
+    
+    Patient patient, received;
+    memset(&patient, 0, sizeof(patient));
+    strcpy(patient.name, "microbench");
+    
+    for (long i = 0; i < ops; i++) {
+        patient.priority = (int)(i % NUM_PRIORITIES) + 1;
+        while (send_patient_to_queue(&patient) != 0) {
+            // Fila cheia: receber primeiro
+            receive_patient_from_queue(&received, 0, 0);
+        }
+        while (receive_patient_from_queue(&received, 0, 0) != 0) {
+        }
+    }
+    
+    _exit(0);
+}
+
+/*
+ * Uma configuração com 'processes' processos
+ * Retorna o tempo de parede em ns, ou -1 em caso de erro
+ */
+static long long run_msq(long ops, int processes) {
+    int start_pipe[2];
+    if (pipe(start_pipe) == -1) {
+        perror("Erro ao criar pipe de arranque");
+        return -1;
+    }
+    
+    for (int i = 0; i < processes; i++) {
+        pid_t pid = fork();
+        if (pid == -1) {
+            perror("Erro ao criar processo");
+            return -1;
+        }
+        if (pid == 0) {
+            close(start_pipe[1]);
+            msq_worker(start_pipe[0], ops / processes + (i < ops % processes ? 1 : 0));
+        }
+    }
+    
+    // Fechar a escrita acorda todos os processos ao mesmo tempo (read = 0)
+    close(start_pipe[0]);
+    long long begin = bench_now_ns();
+    close(start_pipe[1]);
+    
+    while (wait(NULL) > 0) {
+    }
+    
+    return bench_now_ns() - begin;
+}
+
+int main(int argc, char *argv[]) {
+    long ops;
+    int max_workers;
+    
+    if (bench_init(argc, argv, &ops, &max_workers) != 0 || bench_ipc_in_use()) {
+        return EXIT_FAILURE;
+    }
+    
+    if (create_shared_memory() != 0 || create_message_queue() != 0) {
+        return EXIT_FAILURE;
+    }
+    
+    Config config;
+    memset(&config, 0, sizeof(config));
+    config.doctors = 1;
+    parse_doctor_groups("none", &config);
+    publish_doctor_groups(&config);
+    set_queue_discipline(QUEUE_DISCIPLINE_FIFO, 0);
+    
+    bench_header("MSQ: send_patient_to_queue + receive_patient_from_queue", "processos");
+    
+    for (int processes = 1; processes > 0; processes = bench_next_workers(processes, max_workers)) {
+        long long elapsed = run_msq(ops, processes);
+        if (elapsed < 0) {
+            break;
+        }
+        
+        char label[32];
+        snprintf(label, sizeof(label), "%d", processes);
+        bench_row(label, ops, elapsed);
+    }
+    
+    destroy_message_queue();
+    destroy_shared_memory();
+    
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,122 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ *
+ * Micro-benchmark da fila de triagem: enqueue_patient / dequeue_patient
+ * com N threads produtoras e M consumidoras
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "microbench.h"
+#include "triage.h"
+
+typedef struct {
+    TriageQueue *queue;
+    Patient *patient;
+    long ops;
+    pthread_barrier_t *start;
+} QueueWorker;
+
+static void* producer(void *arg) {
+    QueueWorker *worker = (QueueWorker *)arg;
+    
+    pthread_barrier_wait(worker->start);
+    for (long i = 0; i < worker->ops; i++) {
+        enqueue_patient(worker->queue, worker->patient);
+    }
+    return NULL;
+}
+
+static void* consumer(void *arg) {
+    QueueWorker *worker = (QueueWorker *)arg;
+    
+    pthread_barrier_wait(worker->start);
+    for (long i = 0; i < worker->ops; i++) {
+        dequeue_patient(worker->queue);
+    }
+    return NULL;
+}
+
+/*
+ * Uma configuração: 'ops' pacientes passam pela fila, repartidos pelos
+ * produtores e pelos consumidores
+ * Retorna o tempo de parede em ns, ou -1 em caso de erro
+ */
+static long long run_queue(long ops, int producers, int consumers) {
+    // Capacidade para todos: os produtores nunca encontram a fila cheia
+    TriageQueue *queue = create_triage_queue((int)ops);
+    if (queue == NULL) {
+        return -1;
+    }
+    
+    Patient patient;
+    memset(&patient, 0, sizeof(patient));
+    strcpy(patient.name, "microbench");
+    patient.priority = 3;
+    
+    pthread_barrier_t start;
+    pthread_barrier_init(&start, NULL, producers + consumers + 1);
+    
+    int total = producers + consumers;
+    pthread_t threads[2 * MICROBENCH_MAX_THREADS];
+    QueueWorker workers[2 * MICROBENCH_MAX_THREADS];
+    
+    for (int i = 0; i < total; i++) {
+        int is_producer = (i < producers);
+        int count = is_producer ? producers : consumers;
+        int index = is_producer ? i : i - producers;
+        
+        workers[i].queue = queue;
+        workers[i].patient = &patient;
+        workers[i].ops = ops / count + (index < ops % count ? 1 : 0);
+        workers[i].start = &start;
+        pthread_create(&threads[i], NULL, is_producer ? producer : consumer, &workers[i]);
+    }
+    
+    pthread_barrier_wait(&start);
+    long long begin = bench_now_ns();
+    for (int i = 0; i < total; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    long long elapsed = bench_now_ns() - begin;
+    
+    pthread_barrier_destroy(&start);
+    destroy_triage_queue(queue);
+    
+    return elapsed;
+}
+
+int main(int argc, char *argv[]) {
+    long ops;
+    int max_workers;
+    
+    if (bench_init(argc, argv, &ops, &max_workers) != 0) {
+        return EXIT_FAILURE;
+    }
+    if (max_workers > MICROBENCH_MAX_THREADS) {
+        max_workers = MICROBENCH_MAX_THREADS;
+    }
+    
+    bench_header("Fila de triagem: enqueue_patient + dequeue_patient", "produt./consum.");
+    
+    for (int producers = 1; producers > 0; producers = bench_next_workers(producers, max_workers)) {
+        for (int consumers = 1; consumers > 0; consumers = bench_next_workers(consumers, max_workers)) {
+            long long elapsed = run_queue(ops, producers, consumers);
+            if (elapsed < 0) {
+                fprintf(stderr, "ERRO: Falha ao criar fila de triagem\n");
+                return EXIT_FAILURE;
+            }
+            
+            char config[32];
+            snprintf(config, sizeof(config), "%dP/%dC", producers, consumers);
+            bench_row(config, ops, elapsed);
+        }
+    }
+    
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,98 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ *
+ * Micro-benchmark das estatísticas na memória partilhada:
+ * update_triaged_stats / update_attended_stats em K processos (mutex
+ * PTHREAD_PROCESS_SHARED, como triagem e Doctors)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "microbench.h"
+#include "shm.h"
+
+/*
+ * Um processo: 'ops' atualizações, alternando triagem e atendimento
+ */
+static void stats_worker(int start_fd, long ops) {
+    char go;
+    read(start_fd, &go, 1);
+    
+    for (long i = 0; i < ops; i++) {
+        if (i % 2 == 0) {
+            update_triaged_stats(0.001);
+        } else {
+            update_attended_stats((int)(i % NUM_PRIORITIES) + 1, 0.002, 0.004, -1.0);
+        }
+    }
+    
+    _exit(0);
+}
+
+/*
+ * Uma configuração com 'processes' processos
+ * Retorna o tempo de parede em ns, ou -1 em caso de erro
+ */
+static long long run_stats(long ops, int processes) {
+    int start_pipe[2];
+    if (pipe(start_pipe) == -1) {
+        perror("Erro ao criar pipe de arranque");
+        return -1;
+    }
+    
+    for (int i = 0; i < processes; i++) {
+        pid_t pid = fork();
+        if (pid == -1) {
+            perror("Erro ao criar processo");
+            return -1;
+        }
+        if (pid == 0) {
+            close(start_pipe[1]);
+            stats_worker(start_pipe[0], ops / processes + (i < ops % processes ? 1 : 0));
+        }
+    }
+    
+    close(start_pipe[0]);
+    long long begin = bench_now_ns();
+    close(start_pipe[1]);
+    
+    while (wait(NULL) > 0) {
+    }
+    
+    return bench_now_ns() - begin;
+}
+
+int main(int argc, char *argv[]) {
+    long ops;
+    int max_workers;
+    
+    if (bench_init(argc, argv, &ops, &max_workers) != 0 || bench_ipc_in_use()) {
+        return EXIT_FAILURE;
+    }
+    
+    if (create_shared_memory() != 0) {
+        return EXIT_FAILURE;
+    }
+    
+    bench_header("SHM: update_triaged_stats / update_attended_stats", "processos");
+    
+    for (int processes = 1; processes > 0; processes = bench_next_workers(processes, max_workers)) {
+        long long elapsed = run_stats(ops, processes);
+        if (elapsed < 0) {
+            break;
+        }
+        
+        char label[32];
+        snprintf(label, sizeof(label), "%d", processes);
+        bench_row(label, ops, elapsed);
+    }
+    
+    destroy_shared_memory();
+    
+    return EXIT_SUCCESS;
+}
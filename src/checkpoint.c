@@ -0,0 +1,305 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "checkpoint.h"
+#include "triage.h"
+#include "msq.h"
+#include "log.h"
+
+#define DEBUG
+
+/* Ficheiro de checkpoint mapeado em memória */
+static CheckpointFile *checkpoint = NULL;
+static int checkpoint_fd = -1;
+
+/*
+ * Abre e mapeia o ficheiro de checkpoint
+ * Com recover = 0 o conteúdo anterior é descartado; com recover = 1 é
+ * mantido (se for um checkpoint válido) para restore_checkpoint()
+ * Retorna 0 em caso de sucesso (ou se já estiver aberto), -1 em caso de erro
+ */
+int open_checkpoint(int recover) {
+    if (checkpoint != NULL) {
+        return 0;
+    }
+    
+    checkpoint_fd = open(CHECKPOINT_FILENAME, O_RDWR | O_CREAT, 0666);
+    if (checkpoint_fd == -1) {
+        perror("Erro ao abrir ficheiro de checkpoint");
+        return -1;
+    }
+    
+    struct stat st;
+    if (fstat(checkpoint_fd, &st) == -1) {
+        perror("Erro ao obter tamanho do ficheiro de checkpoint");
+        close(checkpoint_fd);
+        checkpoint_fd = -1;
+        return -1;
+    }
+    
+    // Um ficheiro com outro tamanho é de outra versão do programa
+    int fresh = !recover || st.st_size != (off_t)sizeof(CheckpointFile);
+    if (fresh && ftruncate(checkpoint_fd, sizeof(CheckpointFile)) == -1) {
+        perror("Erro ao definir tamanho do ficheiro de checkpoint");
+        close(checkpoint_fd);
+        checkpoint_fd = -1;
+        return -1;
+    }
+    
+    checkpoint = mmap(NULL, sizeof(CheckpointFile), PROT_READ | PROT_WRITE, MAP_SHARED,
+                      checkpoint_fd, 0);
+    if (checkpoint == MAP_FAILED) {
+        perror("Erro ao mapear ficheiro de checkpoint");
+        close(checkpoint_fd);
+        checkpoint_fd = -1;
+        checkpoint = NULL;
+        return -1;
+    }
+    
+    if (!fresh && (checkpoint->magic != CHECKPOINT_MAGIC ||
+                   checkpoint->version != CHECKPOINT_VERSION)) {
+        write_log("AVISO: Ficheiro de checkpoint inválido, a ignorar");
+        fresh = 1;
+    }
+    
+    if (fresh) {
+        checkpoint->magic = CHECKPOINT_MAGIC;
+        checkpoint->version = CHECKPOINT_VERSION;
+        atomic_store(&checkpoint->active, -1);
+        checkpoint->slots[0].seq = 0;
+        checkpoint->slots[1].seq = 0;
+    }
+    
+    #ifdef DEBUG
+    printf("[DEBUG] Checkpoint %s mapeado (%zu bytes)\n", CHECKPOINT_FILENAME, sizeof(CheckpointFile));
+    #endif
+    
+    return 0;
+}
+
+/*
+ * Copia os contadores da memória partilhada para o checkpoint
+ */
+static void copy_stats_out(CheckpointStats *stats) {
+    pthread_mutex_lock(&shm_stats->mutex);
+    stats->total_triaged = shm_stats->total_triaged;
+    stats->total_attended = shm_stats->total_attended;
+    stats->total_wait_triage = shm_stats->total_wait_triage;
+    stats->total_wait_doctor = shm_stats->total_wait_doctor;
+    stats->total_time_system = shm_stats->total_time_system;
+    memcpy(stats->attended_by_priority, shm_stats->attended_by_priority, sizeof(stats->attended_by_priority));
+    memcpy(stats->wait_doctor_by_priority, shm_stats->wait_doctor_by_priority,
+           sizeof(stats->wait_doctor_by_priority));
+    memcpy(stats->sla_missed, shm_stats->sla_missed, sizeof(stats->sla_missed));
+    memcpy(stats->lateness_hist, shm_stats->lateness_hist, sizeof(stats->lateness_hist));
+    memcpy(stats->latency_hist, shm_stats->latency_hist, sizeof(stats->latency_hist));
+    pthread_mutex_unlock(&shm_stats->mutex);
+    
+    for (int g = 0; g < MAX_DOCTOR_GROUPS; g++) {
+        stats->steals[g] = atomic_load(&shm_stats->steals[g]);
+    }
+}
+
+/*
+ * Repõe os contadores da memória partilhada a partir do checkpoint
+ */
+static void copy_stats_in(const CheckpointStats *stats) {
+    pthread_mutex_lock(&shm_stats->mutex);
+    shm_stats->total_triaged = stats->total_triaged;
+    shm_stats->total_attended = stats->total_attended;
+    shm_stats->total_wait_triage = stats->total_wait_triage;
+    shm_stats->total_wait_doctor = stats->total_wait_doctor;
+    shm_stats->total_time_system = stats->total_time_system;
+    memcpy(shm_stats->attended_by_priority, stats->attended_by_priority, sizeof(stats->attended_by_priority));
+    memcpy(shm_stats->wait_doctor_by_priority, stats->wait_doctor_by_priority,
+           sizeof(stats->wait_doctor_by_priority));
+    memcpy(shm_stats->sla_missed, stats->sla_missed, sizeof(stats->sla_missed));
+    memcpy(shm_stats->lateness_hist, stats->lateness_hist, sizeof(stats->lateness_hist));
+    memcpy(shm_stats->latency_hist, stats->latency_hist, sizeof(stats->latency_hist));
+    pthread_mutex_unlock(&shm_stats->mutex);
+    
+    for (int g = 0; g < MAX_DOCTOR_GROUPS; g++) {
+        atomic_store(&shm_stats->steals[g], stats->steals[g]);
+    }
+}
+
+/*
+ * Escreve um instantâneo da fila de triagem, da fila de atendimento e das
+ * estatísticas no checkpoint. Escreve sempre no instantâneo inativo e só
+ * depois o marca como ativo
+ * Um paciente que passe da triagem para a fila de atendimento durante a
+ * cópia pode não ficar em nenhuma das duas. Os pacientes além de
+ * CHECKPOINT_MAX_PATIENTS ficam de fora e são contados em 'omitted'
+ * Retorna 0 em caso de sucesso, -1 em caso de erro
+ */
+int save_checkpoint(int patient_counter) {
+    static int last_omitted = 0;
+    
+    if (checkpoint == NULL || shm_stats == NULL || triage_queue == NULL) {
+        return -1;
+    }
+    
+    int active = atomic_load(&checkpoint->active);
+    int target = (active == 0) ? 1 : 0;
+    CheckpointSlot *slot = &checkpoint->slots[target];
+    
+    unsigned long long seq = (active >= 0) ? checkpoint->slots[active].seq + 1 : 1;
+    
+    slot->triage_count = snapshot_triage_queue(triage_queue, slot->patients, CHECKPOINT_MAX_PATIENTS,
+                                               &slot->accepted, &slot->omitted);
+    
+    int room = CHECKPOINT_MAX_PATIENTS - slot->triage_count;
+    int queued = snapshot_message_queue(slot->patients + slot->triage_count, room);
+    slot->queue_count = (queued > 0) ? queued : 0;
+    
+    // Com o instantâneo cheio, o que resta na fila de atendimento fica de
+    // fora; se a cópia falhou (ex.: kernel sem MSG_COPY), fica toda
+    int in_queue = get_queue_size();
+    if (queued == -1 && in_queue > 0) {
+        slot->omitted += in_queue;
+    } else if (slot->queue_count == room && in_queue > room) {
+        slot->omitted += in_queue - room;
+    }
+    
+    // Só regista quando o checkpoint deixa de ter (ou volta a ter) todos os pacientes
+    if ((slot->omitted > 0) != (last_omitted > 0)) {
+        if (slot->omitted > 0) {
+            write_log("AVISO: Checkpoint sem %d pacientes em fila (máximo %d por instantâneo, "
+                      "ou fila de atendimento não copiada)", slot->omitted, CHECKPOINT_MAX_PATIENTS);
+        } else {
+            write_log("Checkpoint volta a incluir todos os pacientes em fila");
+        }
+        last_omitted = slot->omitted;
+    }
+    
+    copy_stats_out(&slot->stats);
+    slot->patient_counter = patient_counter;
+    clock_gettime(CLOCK_REALTIME, &slot->taken);
+    slot->seq = seq;
+    
+    // Publicar só depois de o instantâneo estar completo
+    atomic_store(&checkpoint->active, target);
+    msync(checkpoint, sizeof(CheckpointFile), MS_ASYNC);
+    
+    return 0;
+}
+
+/*
+ * Chamado no ciclo principal do Admission: grava um checkpoint a cada
+ * CHECKPOINT_INTERVAL_MS (0 = desligado)
+ */
+void checkpoint_tick(const Config *config, int patient_counter) {
+    static struct timespec last = {0, 0};
+    
+    if (checkpoint == NULL || config->checkpoint_interval_ms <= 0) {
+        return;
+    }
+    
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    long elapsed_ms = (now.tv_sec - last.tv_sec) * 1000 + (now.tv_nsec - last.tv_nsec) / 1000000;
+    if (elapsed_ms < config->checkpoint_interval_ms) {
+        return;
+    }
+    last = now;
+    
+    if (save_checkpoint(patient_counter) != 0) {
+        write_log("AVISO: Falha ao gravar checkpoint");
+    }
+}
+
+/*
+ * Retoma o estado do último checkpoint: estatísticas, contador de pacientes
+ * e pacientes em fila (os da fila de atendimento voltam à MSQ, os da
+ * triagem voltam à fila de triagem). Chamado com --recover, depois de
+ * criadas a memória partilhada, a MSQ, a triagem e os Doctors
+ * Retorna o número de pacientes recuperados, ou -1 se não houver checkpoint
+ */
+int restore_checkpoint(int *patient_counter) {
+    if (checkpoint == NULL || shm_stats == NULL || triage_queue == NULL) {
+        return -1;
+    }
+    
+    int active = atomic_load(&checkpoint->active);
+    if (active < 0 || active > 1) {
+        return -1;
+    }
+    
+    CheckpointSlot *slot = &checkpoint->slots[active];
+    copy_stats_in(&slot->stats);
+    *patient_counter = slot->patient_counter;
+    
+    // Os pacientes da triagem voltam a contar como aceites ao entrar na fila
+    set_triage_accepted(triage_queue, slot->accepted - slot->triage_count);
+    
+    int restored = 0;
+    
+    for (int i = slot->triage_count; i < slot->triage_count + slot->queue_count; i++) {
+        Patient *patient = &slot->patients[i];
+        patient->block = NULL;
+        if (send_patient_to_queue(patient) == 0) {
+            restored++;
+        } else {
+            write_log("AVISO: Paciente %s do checkpoint não coube na fila de atendimento",
+                     patient->name);
+        }
+    }
+    
+    for (int i = 0; i < slot->triage_count; i++) {
+        Patient *patient = (Patient *)malloc(sizeof(Patient));
+        if (patient == NULL) {
+            perror("Erro ao alocar memória para paciente recuperado");
+            break;
+        }
+        
+        memcpy(patient, &slot->patients[i], sizeof(Patient));
+        patient->block = NULL;   // O bloco de origem não existe neste processo
+        
+        if (enqueue_patient(triage_queue, patient) != 0) {
+            free_patient(patient);
+            continue;
+        }
+        restored++;
+    }
+    
+    char taken[32];
+    struct tm tm_info;
+    localtime_r(&slot->taken.tv_sec, &tm_info);
+    strftime(taken, sizeof(taken), "%Y-%m-%d %H:%M:%S", &tm_info);
+    
+    write_log("Checkpoint %llu (%s) recuperado: %d atendidos, %d pacientes de volta às filas",
+              slot->seq, taken, slot->stats.total_attended, restored);
+    if (slot->omitted > 0) {
+        write_log("AVISO: %d pacientes em fila não couberam no checkpoint e foram perdidos",
+                  slot->omitted);
+    }
+    
+    return restored;
+}
+
+/*
+ * Desmapeia e fecha o ficheiro de checkpoint (o ficheiro fica no disco)
+ */
+void close_checkpoint() {
+    if (checkpoint != NULL) {
+        msync(checkpoint, sizeof(CheckpointFile), MS_SYNC);
+        munmap(checkpoint, sizeof(CheckpointFile));
+        checkpoint = NULL;
+    }
+    
+    if (checkpoint_fd != -1) {
+        close(checkpoint_fd);
+        checkpoint_fd = -1;
+    }
+}
@@ -0,0 +1,66 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdatomic.h>
+#include <time.h>
+#include "config.h"
+#include "patient.h"
+#include "shm.h"
+
+#define CHECKPOINT_FILENAME "urgencias.ckpt"
+#define CHECKPOINT_MAGIC 0x55524743u        // "URGC"
+#define CHECKPOINT_VERSION 4
+#define CHECKPOINT_MAX_PATIENTS 2048        // Triagem + fila de atendimento
+
+/* Contadores da memória partilhada guardados no checkpoint */
+typedef struct {
+    int total_triaged;
+    int total_attended;
+    double total_wait_triage;
+    double total_wait_doctor;
+    double total_time_system;
+    int attended_by_priority[NUM_PRIORITIES];
+    double wait_doctor_by_priority[NUM_PRIORITIES];
+    int sla_missed[NUM_PRIORITIES];
+    int lateness_hist[NUM_PRIORITIES][SLA_HIST_BUCKETS];
+    int latency_hist[LATENCY_HIST_BUCKETS];
+    long long steals[MAX_DOCTOR_GROUPS];
+} CheckpointStats;
+
+/* Um instantâneo completo do estado */
+typedef struct {
+    unsigned long long seq;         // Número do instantâneo (0 = vazio)
+    struct timespec taken;          // Hora do instantâneo (CLOCK_REALTIME)
+    int patient_counter;            // Último número de chegada atribuído
+    long accepted;                  // Pacientes aceites na triagem até aqui
+    int triage_count;               // patients[0..triage_count-1]: fila de triagem
+    int queue_count;                // Seguintes queue_count: fila de atendimento
+    int omitted;                    // Pacientes em fila que não couberam no instantâneo
+    CheckpointStats stats;
+    Patient patients[CHECKPOINT_MAX_PATIENTS];
+} CheckpointSlot;
+
+/* Ficheiro mapeado: dois instantâneos alternados, para que uma falha a meio
+ * da escrita deixe sempre o anterior válido */
+typedef struct {
+    unsigned int magic;
+    int version;
+    atomic_int active;              // Instantâneo válido mais recente (-1 = nenhum)
+    CheckpointSlot slots[2];
+} CheckpointFile;
+
+/* Funções para gestão do checkpoint */
+int open_checkpoint(int recover);
+int save_checkpoint(int patient_counter);
+void checkpoint_tick(const Config *config, int patient_counter);
+int restore_checkpoint(int *patient_counter);
+void close_checkpoint();
+
+#endif // CHECKPOINT_H
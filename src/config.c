@@ -9,9 +9,53 @@
 #include <stdlib.h>
 #include <string.h>
 #include "config.h"
+#include "affinity.h"
+#include "policy.h"
+#include "msq.h"
+#include "group.h"
 
 #define DEBUG 
 
+/*
+ * Lê um parâmetro opcional inteiro ("CHAVE = valor" ou "CHAVE= valor")
+ * Retorna 1 se a linha corresponde à chave, 0 caso contrário
+ */
+static int parse_optional_int(const char *line, const char *key, int *value) {
+    char format[64];
+    
+    snprintf(format, sizeof(format), "%s = %%d", key);
+    if (sscanf(line, format, value) == 1) {
+        return 1;
+    }
+    
+    snprintf(format, sizeof(format), "%s= %%d", key);
+    if (sscanf(line, format, value) == 1) {
+        return 1;
+    }
+    
+    return 0;
+}
+
+/*
+ * Lê um parâmetro opcional de texto (uma palavra, sem espaços)
+ * Retorna 1 se a linha corresponde à chave, 0 caso contrário
+ */
+static int parse_optional_string(const char *line, const char *key, char *value, size_t size) {
+    char format[64];
+    char buffer[CONFIG_STRING_SIZE];
+    
+    snprintf(format, sizeof(format), "%s = %%%ds", key, CONFIG_STRING_SIZE - 1);
+    if (sscanf(line, format, buffer) != 1) {
+        snprintf(format, sizeof(format), "%s= %%%ds", key, CONFIG_STRING_SIZE - 1);
+        if (sscanf(line, format, buffer) != 1) {
+            return 0;
+        }
+    }
+    
+    snprintf(value, size, "%s", buffer);
+    return 1;
+}
+
 /* 
  * Carrega as configurações a partir de um ficheiro
  * Retorna 0 em caso de sucesso, -1 em caso de erro
@@ -32,6 +76,27 @@ int load_config(const char *filename, Config *config) {
     config->doctors = 0;
     config->shift_length = 0;
     config->msq_wait_max = 0;
+    
+    // Valores por omissão dos parâmetros opcionais
+    config->triage_autoscale = 0;
+    config->triage_min = 1;
+    config->triage_max = 100;
+    config->triage_cpus[0] = '\0';
+    config->doctor_cpus[0] = '\0';
+    config->warm_doctors = 0;
+    config->temp_doctors_max = 10;
+    
+    char sched_policy[CONFIG_STRING_SIZE] = "strict";
+    char sched_weights[CONFIG_STRING_SIZE] = "16,8,4,2,1";
+    char sched_aging_ms[CONFIG_STRING_SIZE] = "0,2000,2000,2000,2000";
+    char sla_target_ms[CONFIG_STRING_SIZE] = "500,1000,2000,5000,10000";
+    char queue_discipline[CONFIG_STRING_SIZE] = "fifo";
+    config->sjf_max_wait_ms = 5000;
+    char doctor_groups[CONFIG_STRING_SIZE] = "none";
+    config->drain_timeout_ms = 5000;
+    config->checkpoint_interval_ms = 1000;
+    config->patient_trace_max = 0;
+    config->timeline_max_events = 0;
 
     while (fgets(line, sizeof(line), file) != NULL) {
         // Remover comentários e linhas vazias
@@ -74,6 +139,93 @@ int load_config(const char *filename, Config *config) {
             #endif
             loaded++;
         }
+        // Parâmetros opcionais (não contam para o total obrigatório)
+        else if (parse_optional_int(line, "TRIAGE_AUTOSCALE", &config->triage_autoscale)) {
+            #ifdef DEBUG
+            printf("[DEBUG] TRIAGE_AUTOSCALE = %d\n", config->triage_autoscale);
+            #endif
+        }
+        else if (parse_optional_int(line, "TRIAGE_MIN", &config->triage_min)) {
+            #ifdef DEBUG
+            printf("[DEBUG] TRIAGE_MIN = %d\n", config->triage_min);
+            #endif
+        }
+        else if (parse_optional_int(line, "TRIAGE_MAX", &config->triage_max)) {
+            #ifdef DEBUG
+            printf("[DEBUG] TRIAGE_MAX = %d\n", config->triage_max);
+            #endif
+        }
+        else if (parse_optional_int(line, "WARM_DOCTORS", &config->warm_doctors)) {
+            #ifdef DEBUG
+            printf("[DEBUG] WARM_DOCTORS = %d\n", config->warm_doctors);
+            #endif
+        }
+        else if (parse_optional_int(line, "TEMP_DOCTORS_MAX", &config->temp_doctors_max)) {
+            #ifdef DEBUG
+            printf("[DEBUG] TEMP_DOCTORS_MAX = %d\n", config->temp_doctors_max);
+            #endif
+        }
+        else if (parse_optional_string(line, "SCHED_POLICY", sched_policy, sizeof(sched_policy)) ||
+                 parse_optional_string(line, "SCHED_WEIGHTS", sched_weights, sizeof(sched_weights)) ||
+                 parse_optional_string(line, "SCHED_AGING_MS", sched_aging_ms, sizeof(sched_aging_ms))) {
+            #ifdef DEBUG
+            printf("[DEBUG] Política de escalonamento: %s", line);
+            #endif
+        }
+        else if (parse_optional_string(line, "SLA_TARGET_MS", sla_target_ms, sizeof(sla_target_ms))) {
+            #ifdef DEBUG
+            printf("[DEBUG] SLA_TARGET_MS = %s\n", sla_target_ms);
+            #endif
+        }
+        else if (parse_optional_string(line, "QUEUE_DISCIPLINE", queue_discipline, 
+                                       sizeof(queue_discipline))) {
+            #ifdef DEBUG
+            printf("[DEBUG] QUEUE_DISCIPLINE = %s\n", queue_discipline);
+            #endif
+        }
+        else if (parse_optional_int(line, "SJF_MAX_WAIT_MS", &config->sjf_max_wait_ms)) {
+            #ifdef DEBUG
+            printf("[DEBUG] SJF_MAX_WAIT_MS = %d\n", config->sjf_max_wait_ms);
+            #endif
+        }
+        else if (parse_optional_string(line, "DOCTOR_GROUPS", doctor_groups, 
+                                       sizeof(doctor_groups))) {
+            #ifdef DEBUG
+            printf("[DEBUG] DOCTOR_GROUPS = %s\n", doctor_groups);
+            #endif
+        }
+        else if (parse_optional_int(line, "DRAIN_TIMEOUT_MS", &config->drain_timeout_ms)) {
+            #ifdef DEBUG
+            printf("[DEBUG] DRAIN_TIMEOUT_MS = %d\n", config->drain_timeout_ms);
+            #endif
+        }
+        else if (parse_optional_int(line, "CHECKPOINT_INTERVAL_MS", &config->checkpoint_interval_ms)) {
+            #ifdef DEBUG
+            printf("[DEBUG] CHECKPOINT_INTERVAL_MS = %d\n", config->checkpoint_interval_ms);
+            #endif
+        }
+        else if (parse_optional_int(line, "PATIENT_TRACE_MAX", &config->patient_trace_max)) {
+            #ifdef DEBUG
+            printf("[DEBUG] PATIENT_TRACE_MAX = %d\n", config->patient_trace_max);
+            #endif
+        }
+        else if (parse_optional_int(line, "TIMELINE_MAX_EVENTS", &config->timeline_max_events)) {
+            #ifdef DEBUG
+            printf("[DEBUG] TIMELINE_MAX_EVENTS = %d\n", config->timeline_max_events);
+            #endif
+        }
+        else if (parse_optional_string(line, "TRIAGE_CPUS", config->triage_cpus, 
+                                       sizeof(config->triage_cpus))) {
+            #ifdef DEBUG
+            printf("[DEBUG] TRIAGE_CPUS = %s\n", config->triage_cpus);
+            #endif
+        }
+        else if (parse_optional_string(line, "DOCTOR_CPUS", config->doctor_cpus, 
+                                       sizeof(config->doctor_cpus))) {
+            #ifdef DEBUG
+            printf("[DEBUG] DOCTOR_CPUS = %s\n", config->doctor_cpus);
+            #endif
+        }
     }
 
     fclose(file);
@@ -92,6 +244,95 @@ int load_config(const char *filename, Config *config) {
         fprintf(stderr, "ERRO: Valores de configuração inválidos (devem ser > 0)\n");
         return -1;
     }
+    
+    if (config->triage_autoscale &&
+        (config->triage_min < 1 || config->triage_max > 100 || 
+         config->triage_min > config->triage_max)) {
+        fprintf(stderr, "ERRO: TRIAGE_MIN/TRIAGE_MAX inválidos (1 <= MIN <= MAX <= 100)\n");
+        return -1;
+    }
+    
+    if (config->warm_doctors < 0 || config->warm_doctors > 100) {
+        fprintf(stderr, "ERRO: WARM_DOCTORS inválido (0-100)\n");
+        return -1;
+    }
+    
+    if (config->temp_doctors_max < 0 || config->temp_doctors_max > 100) {
+        fprintf(stderr, "ERRO: TEMP_DOCTORS_MAX inválido (0-100)\n");
+        return -1;
+    }
+    
+    config->sched_policy = parse_sched_policy(sched_policy);
+    if (config->sched_policy < 0) {
+        fprintf(stderr, "ERRO: SCHED_POLICY inválida (strict, aging, wfq ou edf)\n");
+        return -1;
+    }
+    
+    if (parse_priority_list(sched_weights, config->sched_weights) != 0 ||
+        parse_priority_list(sched_aging_ms, config->sched_aging_ms) != 0) {
+        fprintf(stderr, "ERRO: SCHED_WEIGHTS/SCHED_AGING_MS inválidos (5 inteiros >= 0, separados por vírgulas)\n");
+        return -1;
+    }
+    
+    for (int p = 0; p < NUM_PRIORITIES; p++) {
+        if (config->sched_weights[p] <= 0) {
+            fprintf(stderr, "ERRO: SCHED_WEIGHTS deve ter pesos > 0\n");
+            return -1;
+        }
+    }
+    
+    if (parse_priority_list(sla_target_ms, config->sla_target_ms) != 0) {
+        fprintf(stderr, "ERRO: SLA_TARGET_MS inválido (5 inteiros >= 0, separados por vírgulas)\n");
+        return -1;
+    }
+    
+    if (strcmp(queue_discipline, "fifo") == 0) {
+        config->queue_discipline = QUEUE_DISCIPLINE_FIFO;
+    } else if (strcmp(queue_discipline, "sjf") == 0) {
+        config->queue_discipline = QUEUE_DISCIPLINE_SJF;
+    } else {
+        fprintf(stderr, "ERRO: QUEUE_DISCIPLINE inválida (fifo ou sjf)\n");
+        return -1;
+    }
+    
+    if (config->sjf_max_wait_ms < 0) {
+        fprintf(stderr, "ERRO: SJF_MAX_WAIT_MS inválido (>= 0, 0 = sem limite)\n");
+        return -1;
+    }
+    
+    if (config->drain_timeout_ms < 0) {
+        fprintf(stderr, "ERRO: DRAIN_TIMEOUT_MS inválido (>= 0, 0 = sem drenagem)\n");
+        return -1;
+    }
+    
+    if (config->checkpoint_interval_ms < 0) {
+        fprintf(stderr, "ERRO: CHECKPOINT_INTERVAL_MS inválido (>= 0, 0 = desligado)\n");
+        return -1;
+    }
+    
+    if (config->patient_trace_max < 0) {
+        fprintf(stderr, "ERRO: PATIENT_TRACE_MAX inválido (>= 0, 0 = desligado)\n");
+        return -1;
+    }
+    
+    if (config->timeline_max_events < 0) {
+        fprintf(stderr, "ERRO: TIMELINE_MAX_EVENTS inválido (>= 0, 0 = desligado)\n");
+        return -1;
+    }
+    
+    // Os grupos dependem de DOCTORS, por isso só são lidos no fim
+    if (parse_doctor_groups(doctor_groups, config) != 0) {
+        fprintf(stderr, "ERRO: DOCTOR_GROUPS inválido (none ou \"a-b:n,...\", soma de n = DOCTORS, "
+                        "todas as prioridades cobertas, máximo %d grupos)\n", MAX_DOCTOR_GROUPS);
+        return -1;
+    }
+    
+    CpuList cpus;
+    if (parse_cpu_list(config->triage_cpus, &cpus) != 0 ||
+        parse_cpu_list(config->doctor_cpus, &cpus) != 0) {
+        fprintf(stderr, "ERRO: TRIAGE_CPUS/DOCTOR_CPUS inválidos\n");
+        return -1;
+    }
 
     return 0;
 }
@@ -106,5 +347,48 @@ void print_config(const Config *config) {
     printf("DOCTORS: %d\n", config->doctors);
     printf("SHIFT_LENGTH: %d segundos\n", config->shift_length);
     printf("MSQ_WAIT_MAX: %d\n", config->msq_wait_max);
+    if (config->triage_autoscale) {
+        printf("TRIAGE_AUTOSCALE: %d a %d threads\n", config->triage_min, config->triage_max);
+    }
+    if (config->warm_doctors > 0) {
+        printf("WARM_DOCTORS: %d\n", config->warm_doctors);
+    }
+    printf("TEMP_DOCTORS_MAX: %d\n", config->temp_doctors_max);
+    printf("SCHED_POLICY: %s\n", sched_policy_name(config->sched_policy));
+    printf("SLA_TARGET_MS: %d,%d,%d,%d,%d\n", config->sla_target_ms[0], config->sla_target_ms[1],
+           config->sla_target_ms[2], config->sla_target_ms[3], config->sla_target_ms[4]);
+    if (config->queue_discipline == QUEUE_DISCIPLINE_SJF) {
+        printf("QUEUE_DISCIPLINE: sjf (espera máxima %d ms)\n", config->sjf_max_wait_ms);
+    }
+    if (config->sched_policy == SCHED_POLICY_WFQ) {
+        printf("SCHED_WEIGHTS: %d,%d,%d,%d,%d\n", config->sched_weights[0], config->sched_weights[1],
+               config->sched_weights[2], config->sched_weights[3], config->sched_weights[4]);
+    } else if (config->sched_policy == SCHED_POLICY_AGING) {
+        printf("SCHED_AGING_MS: %d,%d,%d,%d,%d\n", config->sched_aging_ms[0], config->sched_aging_ms[1],
+               config->sched_aging_ms[2], config->sched_aging_ms[3], config->sched_aging_ms[4]);
+    }
+    if (config->num_groups > 1) {
+        printf("DOCTOR_GROUPS:");
+        for (int g = 0; g < config->num_groups; g++) {
+            printf(" %d-%d:%d", config->group_low[g], config->group_high[g], config->group_doctors[g]);
+        }
+        printf("\n");
+    }
+    printf("DRAIN_TIMEOUT_MS: %d\n", config->drain_timeout_ms);
+    if (config->checkpoint_interval_ms > 0) {
+        printf("CHECKPOINT_INTERVAL_MS: %d\n", config->checkpoint_interval_ms);
+    }
+    if (config->patient_trace_max > 0) {
+        printf("PATIENT_TRACE_MAX: %d\n", config->patient_trace_max);
+    }
+    if (config->timeline_max_events > 0) {
+        printf("TIMELINE_MAX_EVENTS: %d\n", config->timeline_max_events);
+    }
+    if (config->triage_cpus[0] != '\0') {
+        printf("TRIAGE_CPUS: %s\n", config->triage_cpus);
+    }
+    if (config->doctor_cpus[0] != '\0') {
+        printf("DOCTOR_CPUS: %s\n", config->doctor_cpus);
+    }
     printf("================================\n");
 }
\ No newline at end of file
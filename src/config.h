@@ -8,6 +8,13 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
+#include "patient.h"
+
+#define CONFIG_STRING_SIZE 128
+
+#define MAX_DOCTOR_GROUPS 4                                     // Grupos de Doctors (DOCTOR_GROUPS)
+#define NUM_QUEUE_LANES (MAX_DOCTOR_GROUPS * NUM_PRIORITIES)    // Filas locais (grupo x prioridade)
+
 /* Estrutura para guardar as configurações do sistema */
 typedef struct {
     int triage_queue_max;    // Tamanho máximo da fila de triagem
@@ -15,6 +22,29 @@ typedef struct {
     int doctors;             // Número de processos doctor
     int shift_length;        // Duração do turno em segundos
     int msq_wait_max;        // Tamanho máximo da fila de atendimento
+    
+    // Parâmetros opcionais (têm valor por omissão)
+    int triage_autoscale;    // 1 = ajustar automaticamente o número de threads de triagem
+    int triage_min;          // Mínimo de threads de triagem (autoscaling)
+    int triage_max;          // Máximo de threads de triagem (autoscaling)
+    char triage_cpus[CONFIG_STRING_SIZE];  // CPUs das threads de triagem ("rr", "0-3,8", "")
+    char doctor_cpus[CONFIG_STRING_SIZE];  // CPUs dos processos Doctor ("rr", "4-7", "")
+    int warm_doctors;        // Doctors em espera (pré-anexados) para picos de carga
+    int temp_doctors_max;    // Máximo de Doctors temporários em simultâneo
+    int sched_policy;        // Política dos Doctors (SCHED_POLICY_*, ver policy.h)
+    int sched_weights[NUM_PRIORITIES];   // Pesos por prioridade (wfq)
+    int sched_aging_ms[NUM_PRIORITIES];  // ms em fila para subir um nível (aging, 0 = nunca)
+    int sla_target_ms[NUM_PRIORITIES];   // Tempo máximo até ao Doctor (desde a chegada)
+    int queue_discipline;    // Ordem dentro de cada prioridade (QUEUE_DISCIPLINE_*, ver msq.h)
+    int sjf_max_wait_ms;     // Espera máxima no modo SJF antes de servir o mais antigo
+    int num_groups;          // Grupos de Doctors (1 = fila única)
+    int group_low[MAX_DOCTOR_GROUPS];       // Primeira prioridade atendida pelo grupo
+    int group_high[MAX_DOCTOR_GROUPS];      // Última prioridade atendida pelo grupo
+    int group_doctors[MAX_DOCTOR_GROUPS];   // Doctors permanentes do grupo
+    int drain_timeout_ms;    // Tempo para escoar os pacientes em fila ao terminar (0 = não escoar)
+    int checkpoint_interval_ms;  // Período do checkpoint das filas e estatísticas (0 = desligado)
+    int patient_trace_max;   // Registos do rasto por paciente em urgencias.trace (0 = desligado)
+    int timeline_max_events; // Eventos da linha temporal em urgencias.events (0 = desligado)
 } Config;
 
 /* Funções para manipular configurações */
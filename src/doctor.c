@@ -15,20 +15,55 @@
 #include <signal.h>
 #include <time.h>
 #include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <dirent.h>
+#include <stdatomic.h>
 #include "doctor.h"
 #include "config.h"
 #include "shm.h"
 #include "msq.h"
 #include "log.h"
+#include "affinity.h"
+#include "policy.h"
+#include "group.h"
+#include "trace.h"
+#include "timeline.h"
+#include "reload.h"
 
 #define DEBUG 
 
 /* Array global para guardar informação dos doctors */
 DoctorInfo *doctors_array = NULL;
 
-/* Contadores para doctors temporários */
-int num_temporary_doctors = 0;
-int temporary_doctor_counter = 0;
+/* Número de doctors permanentes em doctors_array */
+static int doctors_array_size = 0;
+
+/* PIDs dos Doctors temporários e da pool de espera - só usado pelo processo pai */
+static pid_t temp_pids[TEMP_DOCTOR_MAX_PIDS];
+static char temp_is_warm[TEMP_DOCTOR_MAX_PIDS];   // Posição criada pela pool de espera
+static int warm_idle = 0;   // Doctors em espera ainda não ativados
+
+/* CPUs pelas quais os Doctors são distribuídos (DOCTOR_CPUS) */
+static CpuList doctor_cpu_list;
+static int doctor_cpu_list_loaded = 0;
+
+/*
+ * Fixa o processo Doctor atual na CPU correspondente ao índice 'index'
+ */
+static void pin_doctor(int index, const Config *config) {
+    if (!doctor_cpu_list_loaded) {
+        parse_cpu_list(config->doctor_cpus, &doctor_cpu_list);
+        doctor_cpu_list_loaded = 1;
+    }
+    
+    int cpu = cpu_list_pick(&doctor_cpu_list, index);
+    if (cpu >= 0 && pin_process_to_cpu(0, cpu) == 0) {
+        #ifdef DEBUG
+        printf("[DEBUG] Doctor (PID: %d) fixo na CPU %d\n", getpid(), cpu);
+        #endif
+    }
+}
 
 /* Flag para controlar a execução do turno */
 volatile sig_atomic_t shift_active = 1;
@@ -60,32 +95,139 @@ void block_unwanted_signals_doctor() {
 }
 
 /*
- * Função principal executada por cada processo Doctor permanente
+ * Fecha os descritores herdados do Admission (pipes, socket, log, SHM)
+ * Os mapeamentos do log e da memória partilhada continuam válidos
  */
-void doctor_main(int doctor_id, const Config *config) {
-    write_log("Doctor %d: Processo iniciado (PID: %d)", doctor_id, getpid());
+static void close_inherited_fds() {
+    int fds[256];
+    int count;
     
-    // Bloquear sinais indesejados
-    block_unwanted_signals_doctor();
+    // Fechar em blocos de 256 até não restar nenhum descritor herdado
+    do {
+        DIR *dir = opendir("/proc/self/fd");
+        if (dir == NULL) {
+            break;
+        }
+        
+        struct dirent *entry;
+        count = 0;
+        while (count < 256 && (entry = readdir(dir)) != NULL) {
+            int fd = atoi(entry->d_name);
+            if (fd > STDERR_FILENO && fd != dirfd(dir)) {
+                fds[count++] = fd;
+            }
+        }
+        closedir(dir);
+        
+        for (int i = 0; i < count; i++) {
+            close(fds[i]);
+        }
+    } while (count == 256);
     
+    log_fd = -1;
+    shm_fd = -1;
+}
+
+/*
+ * Anexa o processo Doctor à memória partilhada e à fila de mensagens
+ * Retorna 0 em caso de sucesso, -1 em caso de erro
+ */
+static int attach_doctor_resources(const char *label) {
     // Anexar à memória partilhada
     if (attach_shared_memory() != 0) {
-        write_log("ERRO: Doctor %d falhou ao anexar à memória partilhada", doctor_id);
-        exit(EXIT_FAILURE);
+        write_log("ERRO: Doctor %s falhou ao anexar à memória partilhada", label);
+        return -1;
     }
     
     // Obter acesso à fila de mensagens existente
-    key_t key = ftok(MSQ_KEY_PATH, MSQ_KEY_ID);
-    if (key == -1) {
-        write_log("ERRO: Doctor %d falhou ao gerar chave para fila de mensagens", doctor_id);
+    if (attach_message_queue() != 0) {
+        write_log("ERRO: Doctor %s falhou ao aceder à fila de mensagens", label);
         detach_shared_memory();
-        exit(EXIT_FAILURE);
+        return -1;
     }
     
-    msq_id = msgget(key, 0666);
-    if (msq_id == -1) {
-        write_log("ERRO: Doctor %d falhou ao aceder à fila de mensagens", doctor_id);
-        detach_shared_memory();
+    return 0;
+}
+
+/*
+ * Configura SIGTERM para terminar o Doctor de forma controlada
+ * Sem SA_RESTART, para que um sem_wait em curso seja interrompido
+ */
+static int setup_doctor_sigterm() {
+    struct sigaction sa_term;
+    sa_term.sa_handler = sigalrm_handler; // Reutilizar handler de fim de turno
+    sigemptyset(&sa_term.sa_mask);
+    sa_term.sa_flags = 0;
+    
+    return sigaction(SIGTERM, &sa_term, NULL);
+}
+
+/*
+ * Work stealing: com as lanes do próprio grupo vazias, tenta retirar um
+ * paciente das lanes dos outros grupos, só em prioridades que o próprio
+ * grupo também atende (um Doctor de 1-2 nunca leva um paciente de 4)
+ * Retorna o grupo de onde o paciente foi retirado, ou -1 se não houver
+ */
+static int steal_patient(Patient *patient, int group) {
+    int num_groups = shm_stats->num_groups;
+    
+    for (int k = 1; k < num_groups; k++) {
+        int victim = (group + k) % num_groups;
+        
+        for (int priority = 1; priority <= NUM_PRIORITIES; priority++) {
+            if (!group_accepts(group, priority) || !group_accepts(victim, priority)) {
+                continue;
+            }
+            if (get_lane_depth(victim, priority) <= 0) {
+                continue;
+            }
+            if (receive_patient_from_queue(patient, victim, priority) == 0) {
+                atomic_fetch_add(&shm_stats->steals[group], 1);
+                return victim;
+            }
+        }
+    }
+    
+    return -1;
+}
+
+/*
+ * Obtém o próximo paciente a atender das lanes do grupo segundo a política
+ * SCHED_POLICY
+ * Se a prioridade escolhida já tiver sido esvaziada por outro Doctor,
+ * recorre à ordem estrita; se o grupo não tiver pacientes, tenta roubar
+ * um a outro grupo
+ * Retorna 0 se obteve um paciente, -1 se a fila estiver vazia
+ */
+static int receive_next_patient(Patient *patient, const Config *config, int group) {
+    long priority = select_next_priority(config, group);
+    
+    if (receive_patient_from_queue(patient, group, priority) != 0 &&
+        (priority == 0 || receive_patient_from_queue(patient, group, 0) != 0)) {
+        group = steal_patient(patient, group);
+        if (group < 0) {
+            return -1;
+        }
+    }
+    
+    policy_patient_dequeued(config, group, patient->priority);
+    return 0;
+}
+
+/*
+ * Função principal executada por cada processo Doctor permanente
+ */
+void doctor_main(int doctor_id, const Config *config) {
+    timeline_set_actor(doctor_id);
+    write_log("Doctor %d: Processo iniciado (PID: %d)", doctor_id, getpid());
+    
+    // Fechar descritores herdados e bloquear sinais indesejados
+    close_inherited_fds();
+    block_unwanted_signals_doctor();
+    
+    char label[16];
+    snprintf(label, sizeof(label), "%d", doctor_id);
+    if (attach_doctor_resources(label) != 0) {
         exit(EXIT_FAILURE);
     }
     
@@ -102,12 +244,7 @@ void doctor_main(int doctor_id, const Config *config) {
     }
     
     // Configurar handler para SIGTERM (terminação pelo pai)
-    struct sigaction sa_term;
-    sa_term.sa_handler = sigalrm_handler; // Reutilizar handler de fim de turno
-    sigemptyset(&sa_term.sa_mask);
-    sa_term.sa_flags = 0;
-    
-    if (sigaction(SIGTERM, &sa_term, NULL) == -1) {
+    if (setup_doctor_sigterm() == -1) {
         write_log("ERRO: Doctor %d falhou ao configurar SIGTERM", doctor_id);
         detach_shared_memory();
         exit(EXIT_FAILURE);
@@ -118,15 +255,31 @@ void doctor_main(int doctor_id, const Config *config) {
     // Configurar alarme para o fim do turno
     alarm(config->shift_length);
     
-    write_log("Doctor %d: Turno iniciado", doctor_id);
+    int group = doctor_group_of(config, doctor_id - 1);
+    write_log("Doctor %d: Turno iniciado (grupo %d, prioridades %d-%d)", doctor_id, 
+             group + 1, config->group_low[group], config->group_high[group]);
+    
+    WorkerUsage *usage = get_worker_usage(USAGE_DOCTOR, doctor_id);
+    long long usage_mark;
+    worker_usage_start(usage, &usage_mark);
+    
+    // Cópia local da configuração, atualizada quando o Admission a recarrega
+    Config live_config = *config;
+    unsigned int config_version = 0;
+    refresh_config(&live_config, &config_version);
     
     // Loop principal do Doctor
     while (shift_active) {
         Patient patient;
         
-        // Tentar obter paciente da fila (prioridade 0 = qualquer, por ordem de urgência)
-        if (receive_patient_from_queue(&patient, 0) == 0) {
-            struct timespec attendance_start, attendance_end;
+        if (refresh_config(&live_config, &config_version)) {
+            write_log("Doctor %d: Configuração versão %u aplicada", doctor_id, config_version);
+        }
+        
+        // Tentar obter paciente da fila (ordem definida pela política)
+        if (receive_next_patient(&patient, &live_config, group) == 0) {
+            struct timespec attendance_start, attendance_end, busy_start, busy_end;
+            clock_gettime(CLOCK_MONOTONIC, &busy_start);
             
             if (clock_gettime(CLOCK_REALTIME, &attendance_start) != 0) {
                 write_log("ERRO: Doctor %d falhou ao obter timestamp inicial", doctor_id);
@@ -150,11 +303,24 @@ void doctor_main(int doctor_id, const Config *config) {
             double total_time = (attendance_end.tv_sec - patient.arrival_time.tv_sec) +
                                (attendance_end.tv_nsec - patient.arrival_time.tv_nsec) / 1e9;
             
+            double lateness = (attendance_start.tv_sec - patient.deadline.tv_sec) +
+                             (attendance_start.tv_nsec - patient.deadline.tv_nsec) / 1e9;
+            
             // Atualizar estatísticas
-            update_attended_stats(wait_time, total_time);
+            update_attended_stats(patient.priority, wait_time, total_time, lateness);
+            trace_patient(&patient, doctor_id, group, &attendance_start, &attendance_end);
+            timeline_record(TL_WAIT_DOCTOR, patient.arrival_number, &patient.triage_end,
+                            &attendance_start);
+            timeline_record(TL_ATTENDANCE, patient.arrival_number, &attendance_start,
+                            &attendance_end);
+            
+            // Utilização do Doctor (da receção ao fim do registo)
+            clock_gettime(CLOCK_MONOTONIC, &busy_end);
+            worker_usage_add(usage, &usage_mark, &busy_start, &busy_end);
         }
     }
     
+    worker_usage_stop(usage, &usage_mark);
     write_log("Doctor %d: Turno terminado (PID: %d)", doctor_id, getpid());
     
     // Desanexar da memória partilhada
@@ -164,72 +330,52 @@ void doctor_main(int doctor_id, const Config *config) {
 }
 
 /*
- * Função principal executada por cada processo Doctor temporário
+ * Ciclo de atendimento de um Doctor temporário já anexado à SHM e à MSQ
+ * Termina quando o controlador de pico baixa o alvo de temporários abaixo
+ * do número em atividade (ou com SIGTERM)
  */
-void temporary_doctor_main(int doctor_id, const Config *config) {
-    write_log("Doctor TEMP-%d: Processo temporário iniciado (PID: %d)", doctor_id, getpid());
-    
-    // Bloquear sinais indesejados
-    block_unwanted_signals_doctor();
-    
-    // Anexar à memória partilhada
-    if (attach_shared_memory() != 0) {
-        write_log("ERRO: Doctor TEMP-%d falhou ao anexar à memória partilhada", doctor_id);
-        exit(EXIT_FAILURE);
-    }
+static void temporary_doctor_loop(int doctor_id, const Config *config) {
+    timeline_set_actor(-doctor_id);
     
-    // Obter acesso à fila de mensagens existente
-    key_t key = ftok(MSQ_KEY_PATH, MSQ_KEY_ID);
-    if (key == -1) {
-        write_log("ERRO: Doctor TEMP-%d falhou ao gerar chave para fila de mensagens", doctor_id);
-        detach_shared_memory();
-        exit(EXIT_FAILURE);
-    }
+    // Temporários reforçam o grupo mais carregado no momento da ativação
+    int group = most_loaded_group();
+    write_log("Doctor TEMP-%d: A trabalhar (sem turno fixo, grupo %d)", doctor_id, group + 1);
     
-    msq_id = msgget(key, 0666);
-    if (msq_id == -1) {
-        write_log("ERRO: Doctor TEMP-%d falhou ao aceder à fila de mensagens", doctor_id);
-        detach_shared_memory();
-        exit(EXIT_FAILURE);
-    }
-    
-    // Configurar handler para SIGTERM
-    struct sigaction sa_term;
-    sa_term.sa_handler = sigalrm_handler;
-    sigemptyset(&sa_term.sa_mask);
-    sa_term.sa_flags = 0;
-    
-    if (sigaction(SIGTERM, &sa_term, NULL) == -1) {
-        write_log("ERRO: Doctor TEMP-%d falhou ao configurar SIGTERM", doctor_id);
-        detach_shared_memory();
-        exit(EXIT_FAILURE);
-    }
+    WorkerUsage *usage = get_worker_usage(USAGE_DOCTOR, -doctor_id);
+    long long usage_mark;
+    worker_usage_start(usage, &usage_mark);
     
-    write_log("Doctor TEMP-%d: A trabalhar (sem turno fixo)", doctor_id);
+    // Um Doctor em espera pode ter sido criado antes de um recarregamento
+    Config live_config = *config;
+    unsigned int config_version = 0;
+    refresh_config(&live_config, &config_version);
     
-    int threshold = (int)(config->msq_wait_max * 0.8); // 80% do máximo
+    int retired = 0;
     
     // Loop principal do Doctor temporário
     while (shift_active) {
-        // Verificar se deve terminar (fila abaixo de 80%)
-        int queue_size = get_queue_size();
-        
-        if (queue_size < 0) {
-            write_log("ERRO: Doctor TEMP-%d falhou ao obter tamanho da fila", doctor_id);
+        // Verificar se há temporários a mais (só leituras atómicas, sem syscalls)
+        int current = atomic_load(&shm_stats->temp_doctors);
+        if (current > atomic_load(&shm_stats->temp_doctors_target)) {
+            if (atomic_compare_exchange_weak(&shm_stats->temp_doctors, &current, current - 1)) {
+                write_log("Doctor TEMP-%d: Dispensado pelo controlador (%d temporários restantes)", 
+                         doctor_id, current - 1);
+                retired = 1;
+                break;
+            }
             continue;
         }
         
-        if (queue_size < threshold) {
-            write_log("Doctor TEMP-%d: Fila abaixo de 80%% (%d < %d). A terminar...", 
-                     doctor_id, queue_size, threshold);
-            break;
+        if (refresh_config(&live_config, &config_version)) {
+            write_log("Doctor TEMP-%d: Configuração versão %u aplicada", doctor_id, config_version);
         }
         
         Patient patient;
         
         // Tentar obter paciente da fila
-        if (receive_patient_from_queue(&patient, 0) == 0) {
-            struct timespec attendance_start, attendance_end;
+        if (receive_next_patient(&patient, &live_config, group) == 0) {
+            struct timespec attendance_start, attendance_end, busy_start, busy_end;
+            clock_gettime(CLOCK_MONOTONIC, &busy_start);
             
             if (clock_gettime(CLOCK_REALTIME, &attendance_start) != 0) {
                 write_log("ERRO: Doctor TEMP-%d falhou ao obter timestamp inicial", doctor_id);
@@ -253,11 +399,30 @@ void temporary_doctor_main(int doctor_id, const Config *config) {
             double total_time = (attendance_end.tv_sec - patient.arrival_time.tv_sec) +
                                (attendance_end.tv_nsec - patient.arrival_time.tv_nsec) / 1e9;
             
+            double lateness = (attendance_start.tv_sec - patient.deadline.tv_sec) +
+                             (attendance_start.tv_nsec - patient.deadline.tv_nsec) / 1e9;
+            
             // Atualizar estatísticas
-            update_attended_stats(wait_time, total_time);
+            update_attended_stats(patient.priority, wait_time, total_time, lateness);
+            trace_patient(&patient, -doctor_id, group, &attendance_start, &attendance_end);
+            timeline_record(TL_WAIT_DOCTOR, patient.arrival_number, &patient.triage_end,
+                            &attendance_start);
+            timeline_record(TL_ATTENDANCE, patient.arrival_number, &attendance_start,
+                            &attendance_end);
+            
+            // Utilização do Doctor (da receção ao fim do registo)
+            clock_gettime(CLOCK_MONOTONIC, &busy_end);
+            worker_usage_add(usage, &usage_mark, &busy_start, &busy_end);
         }
     }
     
+    worker_usage_stop(usage, &usage_mark);
+    
+    // Terminado por SIGTERM: libertar o lugar contado na SHM
+    if (!retired) {
+        atomic_fetch_sub(&shm_stats->temp_doctors, 1);
+    }
+    
     write_log("Doctor TEMP-%d: Processo temporário terminado (PID: %d)", doctor_id, getpid());
     
     // Desanexar da memória partilhada
@@ -266,6 +431,93 @@ void temporary_doctor_main(int doctor_id, const Config *config) {
     exit(EXIT_SUCCESS);
 }
 
+/*
+ * Função principal executada por cada processo Doctor temporário
+ */
+void temporary_doctor_main(int doctor_id, const Config *config) {
+    write_log("Doctor TEMP-%d: Processo temporário iniciado (PID: %d)", doctor_id, getpid());
+    
+    // Fechar descritores herdados e bloquear sinais indesejados
+    close_inherited_fds();
+    block_unwanted_signals_doctor();
+    
+    char label[16];
+    snprintf(label, sizeof(label), "TEMP-%d", doctor_id);
+    if (attach_doctor_resources(label) != 0) {
+        exit(EXIT_FAILURE);
+    }
+    
+    // Configurar handler para SIGTERM
+    if (setup_doctor_sigterm() == -1) {
+        write_log("ERRO: Doctor TEMP-%d falhou ao configurar SIGTERM", doctor_id);
+        detach_shared_memory();
+        exit(EXIT_FAILURE);
+    }
+    
+    temporary_doctor_loop(doctor_id, config);
+}
+
+/*
+ * Função principal de um Doctor em espera (pool WARM_DOCTORS)
+ * Anexa-se à SHM e à MSQ logo à partida e fica bloqueado no semáforo
+ * até o Admission o ativar; a partir daí comporta-se como um temporário
+ * 'slot' é a posição na tabela de temporários, onde marca a ativação
+ */
+static void warm_doctor_main(int slot, const Config *config) {
+    close_inherited_fds();
+    block_unwanted_signals_doctor();
+    
+    // Antes da ativação, qualquer saída usa DOCTOR_WARM_IDLE_EXIT
+    if (attach_doctor_resources("WARM") != 0) {
+        exit(DOCTOR_WARM_IDLE_EXIT);
+    }
+    
+    if (setup_doctor_sigterm() == -1) {
+        write_log("ERRO: Doctor WARM falhou ao configurar SIGTERM");
+        detach_shared_memory();
+        exit(DOCTOR_WARM_IDLE_EXIT);
+    }
+    
+    #ifdef DEBUG
+    printf("[DEBUG] Doctor em espera pronto (PID: %d)\n", getpid());
+    #endif
+    
+    // Aguardar ativação (SIGTERM interrompe o sem_wait)
+    int activated = 0;
+    while (shift_active) {
+        if (sem_wait(&shm_stats->warm_activate) == 0) {
+            // O sem_post não diz que processo acordou: marcar antes de mais
+            // nada, para o Admission saber ao recolher este PID se a
+            // ativação (contada em temp_doctors) era sua
+            atomic_store(&shm_stats->warm_activated[slot], 1);
+            activated = 1;
+            break;
+        }
+        if (errno != EINTR) {
+            write_log("ERRO: Doctor WARM (PID: %d) falhou no sem_wait", getpid());
+            detach_shared_memory();
+            exit(DOCTOR_WARM_IDLE_EXIT);
+        }
+    }
+    
+    if (!activated) {
+        // Terminado sem nunca ter sido ativado
+        detach_shared_memory();
+        exit(DOCTOR_WARM_IDLE_EXIT);
+    }
+    
+    // O Admission já contou este Doctor em temp_doctors ao fazer sem_post
+    // (com SIGTERM entretanto, temporary_doctor_loop desconta-o e termina)
+    
+    int temp_id = atomic_fetch_add(&shm_stats->next_temp_doctor_id, 1) + 1;
+    pin_doctor(config->doctors + temp_id - 1, config);
+    
+    write_log("Doctor TEMP-%d: Ativado a partir da pool de espera (PID: %d)", 
+             temp_id, getpid());
+    
+    temporary_doctor_loop(temp_id, config);
+}
+
 /*
  * Cria um único processo Doctor permanente
  * Retorna o PID do processo criado, ou -1 em caso de erro
@@ -280,6 +532,7 @@ int create_doctor_process(int doctor_id, const Config *config) {
     }
     else if (pid == 0) {
         // Código do processo filho (Doctor)
+        pin_doctor(doctor_id - 1, config);
         doctor_main(doctor_id, config);
         // Nunca chega aqui (doctor_main termina com exit)
     }
@@ -302,31 +555,192 @@ int create_doctor_process(int doctor_id, const Config *config) {
     return -1;
 }
 
+/*
+ * Bloqueia/desbloqueia SIGCHLD enquanto a tabela de temporários é alterada
+ * (a recolha dos filhos também a atualiza)
+ */
+static void temp_table_lock(sigset_t *old_set) {
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &set, old_set);
+}
+
+static void temp_table_unlock(const sigset_t *old_set) {
+    sigprocmask(SIG_SETMASK, old_set, NULL);
+}
+
+/*
+ * Procura uma posição livre na tabela de temporários
+ * Retorna o índice, ou -1 se a tabela estiver cheia
+ */
+static int find_free_temp_slot() {
+    for (int i = 0; i < TEMP_DOCTOR_MAX_PIDS; i++) {
+        if (temp_pids[i] == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Completa a pool de Doctors em espera até WARM_DOCTORS processos inativos
+ * Retorna o número de processos criados
+ */
+int fill_warm_pool(const Config *config) {
+    int created = 0;
+    sigset_t old_set;
+    
+    temp_table_lock(&old_set);
+    
+    while (warm_idle < config->warm_doctors) {
+        int slot = find_free_temp_slot();
+        if (slot < 0) {
+            break;
+        }
+        
+        atomic_store(&shm_stats->warm_activated[slot], 0);
+        
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("Erro ao criar Doctor em espera");
+            break;
+        }
+        else if (pid == 0) {
+            warm_doctor_main(slot, config);
+            // Nunca chega aqui
+        }
+        
+        temp_pids[slot] = pid;
+        temp_is_warm[slot] = 1;
+        warm_idle++;
+        created++;
+    }
+    
+    temp_table_unlock(&old_set);
+    
+    if (created > 0) {
+        write_log("Pool de espera: %d Doctor(s) criado(s), %d em espera", 
+                 created, warm_idle);
+    }
+    
+    return created;
+}
+
+/*
+ * Ativa um Doctor em espera, se houver
+ * Retorna 1 se um Doctor foi ativado, 0 caso contrário
+ */
+static int activate_warm_doctor() {
+    sigset_t old_set;
+    int activated = 0;
+    
+    temp_table_lock(&old_set);
+    if (warm_idle > 0 && sem_post(&shm_stats->warm_activate) == 0) {
+        warm_idle--;
+        atomic_fetch_add(&shm_stats->temp_doctors, 1);
+        activated = 1;
+    }
+    temp_table_unlock(&old_set);
+    
+    return activated;
+}
+
+/*
+ * Trata a terminação de um Doctor temporário ou em espera (chamado ao recolher os filhos)
+ * Um temporário que sai normalmente já descontou temp_doctors na SHM; aqui só
+ * se corrige a contagem de quem terminou de forma anormal
+ * Retorna 1 se o PID era de um temporário, 0 caso contrário
+ */
+int handle_temporary_doctor_exit(pid_t pid, int status) {
+    for (int i = 0; i < TEMP_DOCTOR_MAX_PIDS; i++) {
+        if (temp_pids[i] != pid) {
+            continue;
+        }
+        
+        temp_pids[i] = 0;
+        int idle = temp_is_warm[i] && !atomic_load(&shm_stats->warm_activated[i]);
+        temp_is_warm[i] = 0;
+        
+        if (idle) {
+            // Doctor em espera que nunca foi ativado (saída normal ou sinal)
+            if (warm_idle > 0) {
+                warm_idle--;
+            } else if (sem_trywait(&shm_stats->warm_activate) == 0) {
+                // Havia uma ativação pendente para ele e já não há quem a consuma
+                atomic_fetch_sub(&shm_stats->temp_doctors, 1);
+            }
+        } else if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+            // Temporário (lançado ou ativado da pool) que terminou de forma anormal
+            atomic_fetch_sub(&shm_stats->temp_doctors, 1);
+        }
+        
+        write_log("Doctor temporário (PID: %d) terminou. Temporários restantes: %d", 
+                 pid, atomic_load(&shm_stats->temp_doctors));
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * Número de Doctors temporários em atividade (contagem na SHM)
+ */
+int get_temporary_doctor_count() {
+    if (shm_stats == NULL) {
+        return 0;
+    }
+    return atomic_load(&shm_stats->temp_doctors);
+}
+
 /*
  * Cria um processo Doctor temporário
- * Retorna o PID do processo criado, ou -1 em caso de erro
+ * Usa primeiro um Doctor da pool de espera; só faz fork se a pool estiver vazia
+ * Retorna o PID do processo criado (0 se foi ativado da pool), ou -1 em caso de erro
  */
 int create_temporary_doctor(const Config *config) {
-    temporary_doctor_counter++;
-    int temp_id = temporary_doctor_counter;
+    if (activate_warm_doctor()) {
+        write_log("Doctor temporário ativado da pool de espera. Total temporários: %d", 
+                 get_temporary_doctor_count());
+        return 0;
+    }
+    
+    sigset_t old_set;
+    temp_table_lock(&old_set);
+    
+    int slot = find_free_temp_slot();
+    if (slot < 0) {
+        temp_table_unlock(&old_set);
+        write_log("ERRO: Tabela de Doctors temporários cheia");
+        return -1;
+    }
+    
+    int temp_id = atomic_fetch_add(&shm_stats->next_temp_doctor_id, 1) + 1;
+    
+    // Contar já o novo temporário, antes de o filho arrancar
+    atomic_fetch_add(&shm_stats->temp_doctors, 1);
     
     pid_t pid = fork();
     
     if (pid < 0) {
         perror("Erro ao criar processo Doctor temporário");
+        atomic_fetch_sub(&shm_stats->temp_doctors, 1);
+        temp_table_unlock(&old_set);
         return -1;
     }
     else if (pid == 0) {
         // Código do processo filho (Doctor temporário)
+        // Temporários continuam o round-robin depois dos permanentes
+        pin_doctor(config->doctors + temp_id - 1, config);
         temporary_doctor_main(temp_id, config);
         // Nunca chega aqui
     }
     else {
         // Código do processo pai (Admission)
-        num_temporary_doctors++;
+        temp_pids[slot] = pid;
+        temp_table_unlock(&old_set);
         
         write_log("Doctor temporário TEMP-%d criado (PID: %d). Total temporários: %d", 
-                 temp_id, pid, num_temporary_doctors);
+                 temp_id, pid, get_temporary_doctor_count());
         
         return pid;
     }
@@ -335,22 +749,129 @@ int create_temporary_doctor(const Config *config) {
 }
 
 /*
- * Verifica se deve criar um doctor temporário
+ * Controlador de pico: ajusta o número de Doctors temporários
+ * 
+ * Estima quantos Doctors são necessários para acompanhar a taxa de chegada
+ * à MSQ e escoar o backlog em SURGE_DRAIN_SECONDS, usando a taxa de serviço
+ * observada por Doctor (média móvel, só medida com a fila não vazia).
+ * Sobe logo que a fila atinge MSQ_WAIT_MAX; só desce depois de
+ * SURGE_SHRINK_SAMPLES amostras seguidas abaixo de 80% de MSQ_WAIT_MAX.
+ * Os temporários a mais terminam sozinhos ao ver temp_doctors > alvo.
+ * 
+ * Pode ser chamada em cada iteração do ciclo principal (limita-se a
+ * SURGE_INTERVAL_MS entre amostras)
  */
-void check_and_create_temporary_doctor(const Config *config) {
+void adjust_temporary_doctors(const Config *config) {
+    static struct timespec last_sample;
+    static int last_triaged = 0;
+    static int last_attended = 0;
+    static int last_queue = 0;
+    static double service_rate = 0.0;   // Pacientes/s por Doctor (EWMA)
+    static int shrink_samples = 0;
+    static int initialized = 0;
+    
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    
+    double elapsed = (now.tv_sec - last_sample.tv_sec) +
+                     (now.tv_nsec - last_sample.tv_nsec) / 1e9;
+    if (initialized && elapsed * 1000.0 < SURGE_INTERVAL_MS) {
+        return;
+    }
+    
+    int triaged, attended;
+    get_stats_counters(&triaged, &attended);
+    
     int queue_size = get_queue_size();
+    if (queue_size < 0) {
+        return;
+    }
+    
+    if (!initialized) {
+        last_sample = now;
+        last_triaged = triaged;
+        last_attended = attended;
+        last_queue = queue_size;
+        initialized = 1;
+        return;
+    }
+    
+    int current = get_temporary_doctor_count();
+    int serving = config->doctors + current;
+    double arrival_rate = (triaged - last_triaged) / elapsed;
+    double completion_rate = (attended - last_attended) / elapsed;
+    
+    // Só com fila nos dois extremos do intervalo os Doctors estiveram ocupados
+    if (queue_size > 0 && last_queue > 0 && completion_rate > 0) {
+        double sample = completion_rate / serving;
+        service_rate = (service_rate == 0.0) ? sample :
+                       SURGE_EWMA_ALPHA * sample + (1.0 - SURGE_EWMA_ALPHA) * service_rate;
+    }
+    
+    last_sample = now;
+    last_triaged = triaged;
+    last_attended = attended;
+    last_queue = queue_size;
+    
+    // Número de temporários necessários
+    double needed_extra;
+    if (service_rate > 0.0) {
+        needed_extra = ceil((arrival_rate + queue_size / SURGE_DRAIN_SECONDS) / service_rate)
+                       - config->doctors;
+    } else {
+        // Sem medições: um temporário por cada MSQ_WAIT_MAX pacientes em fila
+        needed_extra = queue_size / config->msq_wait_max;
+    }
+    if (needed_extra < 0) {
+        needed_extra = 0;
+    }
+    if (needed_extra > config->temp_doctors_max) {
+        needed_extra = config->temp_doctors_max;
+    }
+    int needed = (int)needed_extra;
+    
+    int target = atomic_load(&shm_stats->temp_doctors_target);
+    int new_target = target;
+    int low_mark = (int)(config->msq_wait_max * 0.8);
     
     if (queue_size >= config->msq_wait_max) {
-        write_log("ALERTA: Fila de atendimento atingiu o máximo (%d >= %d)", 
-                 queue_size, config->msq_wait_max);
-        
-        // Criar doctor temporário
-        if (create_temporary_doctor(config) > 0) {
-            write_log("Doctor temporário criado para ajudar com a sobrecarga");
-        } else {
+        // Sobrecarga: subir de imediato (pelo menos um temporário)
+        if (needed < 1 && config->temp_doctors_max > 0) {
+            needed = 1;
+        }
+        if (needed > new_target) {
+            new_target = needed;
+        }
+        shrink_samples = 0;
+    } else if (queue_size < low_mark && needed < target) {
+        // Histerese: só descer após várias amostras seguidas
+        if (++shrink_samples >= SURGE_SHRINK_SAMPLES) {
+            new_target = needed;
+            shrink_samples = 0;
+        }
+    } else {
+        shrink_samples = 0;
+    }
+    
+    if (new_target != target) {
+        atomic_store(&shm_stats->temp_doctors_target, new_target);
+        write_log("PICO: fila=%d chegada=%.1f/s serviço=%.2f/s por Doctor -> alvo de temporários %d -> %d",
+                 queue_size, arrival_rate, service_rate, target, new_target);
+    }
+    
+    // Lançar os que faltam de uma vez (a pool de espera é usada primeiro)
+    int to_create = new_target - current;
+    for (int i = 0; i < to_create; i++) {
+        if (create_temporary_doctor(config) < 0) {
             write_log("ERRO: Falha ao criar doctor temporário");
+            break;
         }
     }
+    
+    // Repor a pool de espera (inclui os que foram ativados agora)
+    if (config->warm_doctors > 0) {
+        fill_warm_pool(config);
+    }
 }
 
 /*
@@ -372,6 +893,7 @@ int create_all_doctors(const Config *config) {
     
     // Inicializar array
     memset(doctors_array, 0, config->doctors * sizeof(DoctorInfo));
+    doctors_array_size = config->doctors;
     
     printf("\n=== Criação dos Processos Doctor ===\n");
     
@@ -393,9 +915,88 @@ int create_all_doctors(const Config *config) {
     
     printf("=== %d Processos Doctor criados com sucesso ===\n\n", config->doctors);
     
+    // Pré-criar a pool de Doctors em espera
+    if (config->warm_doctors > 0) {
+        fill_warm_pool(config);
+    }
+    
     return 0;
 }
 
+/*
+ * Trata a terminação de um Doctor permanente (chamado ao recolher os filhos)
+ * Com 'replace', cria outro Doctor com o mesmo ID para o turno seguinte,
+ * desde que o ID ainda faça parte da pool (DOCTORS pode ter diminuído)
+ * Retorna 1 se o PID era de um Doctor permanente, 0 caso contrário
+ */
+int handle_permanent_doctor_exit(pid_t pid, int replace, const Config *config) {
+    for (int i = 0; i < doctors_array_size; i++) {
+        if (doctors_array[i].pid != pid) {
+            continue;
+        }
+        
+        int doctor_id = doctors_array[i].id;
+        doctors_array[i].pid = 0;
+        
+        if (doctor_id > config->doctors) {
+            write_log("Doctor %d (PID: %d) terminou e saiu da pool (DOCTORS = %d)", 
+                     doctor_id, pid, config->doctors);
+            return 1;
+        }
+        
+        write_log("Doctor %d (PID: %d) terminou o turno", doctor_id, pid);
+        
+        if (replace) {
+            write_log("A criar novo Doctor %d para substituir...", doctor_id);
+            create_doctor_process(doctor_id, config);
+        }
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * Ajusta a pool de Doctors permanentes a config->doctors (recarregamento
+ * da configuração): cria os IDs que faltam; os que ficam fora da pool
+ * recebem SIGTERM, acabam o paciente em curso e não são substituídos
+ * Retorna 0 em caso de sucesso, -1 em caso de erro
+ */
+int resize_doctor_pool(const Config *config) {
+    if (doctors_array == NULL) {
+        return -1;
+    }
+    
+    if (config->doctors > doctors_array_size) {
+        DoctorInfo *grown = (DoctorInfo *)realloc(doctors_array, config->doctors * sizeof(DoctorInfo));
+        if (grown == NULL) {
+            perror("Erro ao aumentar doctors_array");
+            return -1;
+        }
+        memset(&grown[doctors_array_size], 0,
+               (config->doctors - doctors_array_size) * sizeof(DoctorInfo));
+        doctors_array = grown;
+        doctors_array_size = config->doctors;
+    }
+    
+    int result = 0;
+    for (int i = 0; i < doctors_array_size; i++) {
+        int doctor_id = i + 1;
+        
+        if (doctor_id <= config->doctors) {
+            // Um ID dispensado que ainda não terminou é substituído quando terminar
+            if (doctors_array[i].pid == 0 && create_doctor_process(doctor_id, config) < 0) {
+                result = -1;
+            }
+        } else if (doctors_array[i].pid > 0) {
+            write_log("Doctor %d (PID: %d) dispensado (DOCTORS = %d)", 
+                     doctor_id, doctors_array[i].pid, config->doctors);
+            kill(doctors_array[i].pid, SIGTERM);
+        }
+    }
+    
+    return result;
+}
+
 /*
  * Termina todos os processos Doctor
  */
@@ -407,7 +1008,7 @@ void terminate_all_doctors() {
     printf("\n=== Terminação dos Processos Doctor ===\n");
     
     // Enviar SIGTERM para todos os doctors
-    for (int i = 0; doctors_array[i].pid != 0; i++) {
+    for (int i = 0; i < doctors_array_size; i++) {
         if (doctors_array[i].pid > 0) {
             #ifdef DEBUG
             printf("[DEBUG] A enviar SIGTERM para Doctor %d (PID: %d)\n", 
@@ -417,12 +1018,19 @@ void terminate_all_doctors() {
         }
     }
     
+    // Terminar também os temporários e a pool de espera
+    for (int i = 0; i < TEMP_DOCTOR_MAX_PIDS; i++) {
+        if (temp_pids[i] > 0) {
+            kill(temp_pids[i], SIGTERM);
+        }
+    }
+    
     // Aguardar pela terminação de todos os doctors
     int status;
     pid_t pid;
     while ((pid = wait(&status)) > 0) {
         // Encontrar qual doctor terminou
-        for (int i = 0; doctors_array[i].pid != 0; i++) {
+        for (int i = 0; i < doctors_array_size; i++) {
             if (doctors_array[i].pid == pid) {
                 printf("[Doctor %d] Processo terminado (PID: %d)\n", 
                        doctors_array[i].id, pid);
@@ -436,4 +1044,8 @@ void terminate_all_doctors() {
     // Libertar memória
     free(doctors_array);
     doctors_array = NULL;
+    doctors_array_size = 0;
+    memset(temp_pids, 0, sizeof(temp_pids));
+    memset(temp_is_warm, 0, sizeof(temp_is_warm));
+    warm_idle = 0;
 }
@@ -11,6 +11,15 @@
 #include <sys/types.h>
 #include "config.h"
 
+#define TEMP_DOCTOR_MAX_PIDS 256    // Máximo de temporários + pool de espera vivos
+#define DOCTOR_WARM_IDLE_EXIT 3     // Código de saída de um Doctor em espera não ativado
+
+/* Controlador de pico (Doctors temporários) */
+#define SURGE_INTERVAL_MS 1000      // Intervalo entre amostras
+#define SURGE_DRAIN_SECONDS 2.0     // Horizonte para escoar o backlog da MSQ
+#define SURGE_SHRINK_SAMPLES 3      // Amostras seguidas abaixo de 80% antes de descer
+#define SURGE_EWMA_ALPHA 0.3        // Peso da amostra nova na taxa de serviço
+
 /* Estrutura para guardar informação de um processo Doctor */
 typedef struct {
     pid_t pid;           // PID do processo
@@ -22,19 +31,22 @@ typedef struct {
 /* Array global para guardar informação dos doctors */
 extern DoctorInfo *doctors_array;
 
-/* Informação sobre doctors temporários */
-extern int num_temporary_doctors;
-extern int temporary_doctor_counter;
-
 /* Funções para gestão dos processos Doctor */
 int create_doctor_process(int doctor_id, const Config *config);
 void doctor_main(int doctor_id, const Config *config);
 void temporary_doctor_main(int doctor_id, const Config *config);
 int create_all_doctors(const Config *config);
+int handle_permanent_doctor_exit(pid_t pid, int replace, const Config *config);
+int resize_doctor_pool(const Config *config);
 void terminate_all_doctors();
 
 /* Funções para doctors temporários */
 int create_temporary_doctor(const Config *config);
-void check_and_create_temporary_doctor(const Config *config);
+void adjust_temporary_doctors(const Config *config);
+int get_temporary_doctor_count();
+
+/* Funções para a pool de Doctors em espera (WARM_DOCTORS) */
+int fill_warm_pool(const Config *config);
+int handle_temporary_doctor_exit(pid_t pid, int status);
 
 #endif // DOCTOR_H
\ No newline at end of file
@@ -0,0 +1,282 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dqueue.h"
+
+/*
+ * Compara duas posições segundo o heap 'kind'
+ * Retorna != 0 se 'a' deve sair antes de 'b'
+ */
+static int dq_before(const DoctorQueue *queue, int kind, int a, int b) {
+    const DoctorQueueSlot *sa = &queue->slots[a];
+    const DoctorQueueSlot *sb = &queue->slots[b];
+    
+    if (kind == DQ_HEAP_SJF && sa->patient.attendance_time != sb->patient.attendance_time) {
+        return sa->patient.attendance_time < sb->patient.attendance_time;
+    }
+    return sa->seq < sb->seq;
+}
+
+/*
+ * Coloca a posição 'slot' no índice 'index' do heap e atualiza heap_pos
+ */
+static void dq_heap_set(DoctorQueue *queue, DoctorQueueHeap *heap, int kind, int index, int slot) {
+    heap->items[index] = slot;
+    queue->slots[slot].heap_pos[kind] = index;
+}
+
+/*
+ * Sobe a posição no índice 'index' até repor a ordem do heap
+ */
+static void dq_sift_up(DoctorQueue *queue, DoctorQueueHeap *heap, int kind, int index) {
+    int slot = heap->items[index];
+    
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (!dq_before(queue, kind, slot, heap->items[parent])) {
+            break;
+        }
+        dq_heap_set(queue, heap, kind, index, heap->items[parent]);
+        index = parent;
+    }
+    dq_heap_set(queue, heap, kind, index, slot);
+}
+
+/*
+ * Desce a posição no índice 'index' até repor a ordem do heap
+ */
+static void dq_sift_down(DoctorQueue *queue, DoctorQueueHeap *heap, int kind, int index) {
+    int slot = heap->items[index];
+    
+    while (1) {
+        int child = 2 * index + 1;
+        if (child >= heap->size) {
+            break;
+        }
+        if (child + 1 < heap->size &&
+            dq_before(queue, kind, heap->items[child + 1], heap->items[child])) {
+            child++;
+        }
+        if (!dq_before(queue, kind, heap->items[child], slot)) {
+            break;
+        }
+        dq_heap_set(queue, heap, kind, index, heap->items[child]);
+        index = child;
+    }
+    dq_heap_set(queue, heap, kind, index, slot);
+}
+
+/*
+ * Remove a posição 'slot' de um heap, esteja onde estiver (O(log n))
+ */
+static void dq_heap_remove(DoctorQueue *queue, DoctorQueueHeap *heap, int kind, int slot) {
+    int index = queue->slots[slot].heap_pos[kind];
+    int last = heap->items[--heap->size];
+    
+    queue->slots[slot].heap_pos[kind] = -1;
+    if (last == slot) {
+        return;
+    }
+    
+    dq_heap_set(queue, heap, kind, index, last);
+    if (index > 0 && dq_before(queue, kind, last, heap->items[(index - 1) / 2])) {
+        dq_sift_up(queue, heap, kind, index);
+    } else {
+        dq_sift_down(queue, heap, kind, index);
+    }
+}
+
+/*
+ * Inicializa a fila (chamado pelo Admission ao criar a memória partilhada)
+ * Retorna 0 em caso de sucesso, -1 em caso de erro
+ */
+int dq_init(DoctorQueue *queue) {
+    pthread_mutexattr_t mutex_attr;
+    pthread_mutexattr_init(&mutex_attr);
+    pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+    
+    if (pthread_mutex_init(&queue->mutex, &mutex_attr) != 0) {
+        perror("Erro ao inicializar mutex da fila SJF");
+        pthread_mutexattr_destroy(&mutex_attr);
+        return -1;
+    }
+    pthread_mutexattr_destroy(&mutex_attr);
+    
+    // Encadear todas as posições na lista de livres
+    for (int i = 0; i < DQ_CAPACITY; i++) {
+        queue->slots[i].next_free = (i + 1 < DQ_CAPACITY) ? i + 1 : -1;
+        queue->slots[i].heap_pos[DQ_HEAP_SJF] = -1;
+        queue->slots[i].heap_pos[DQ_HEAP_FIFO] = -1;
+    }
+    queue->free_head = 0;
+    queue->next_seq = 0;
+    memset(queue->heaps, 0, sizeof(queue->heaps));
+    
+    return 0;
+}
+
+/*
+ * Destrói o mutex da fila
+ */
+void dq_destroy(DoctorQueue *queue) {
+    pthread_mutex_destroy(&queue->mutex);
+}
+
+/*
+ * Insere um paciente nos dois heaps de uma lane
+ * Retorna 0 em caso de sucesso, -1 se a fila estiver cheia
+ */
+int dq_push(DoctorQueue *queue, int lane, const Patient *patient, long long now_ns) {
+    if (lane < 0 || lane >= NUM_QUEUE_LANES) {
+        return -1;
+    }
+    
+    pthread_mutex_lock(&queue->mutex);
+    
+    int slot = queue->free_head;
+    if (slot < 0) {
+        pthread_mutex_unlock(&queue->mutex);
+        return -1;
+    }
+    queue->free_head = queue->slots[slot].next_free;
+    
+    DoctorQueueSlot *entry = &queue->slots[slot];
+    memcpy(&entry->patient, patient, sizeof(Patient));
+    entry->enqueue_ns = now_ns;
+    entry->seq = queue->next_seq++;
+    
+    for (int kind = 0; kind < 2; kind++) {
+        DoctorQueueHeap *heap = &queue->heaps[lane][kind];
+        heap->items[heap->size] = slot;
+        dq_sift_up(queue, heap, kind, heap->size++);
+    }
+    
+    pthread_mutex_unlock(&queue->mutex);
+    return 0;
+}
+
+/*
+ * Retira o paciente de menor attendance_time de uma lane, exceto se
+ * o mais antigo já esperou max_wait_ns: nesse caso sai o mais antigo
+ * Retorna 0 em caso de sucesso, -1 se a lane estiver vazia
+ */
+int dq_pop(DoctorQueue *queue, int lane, long long max_wait_ns, long long now_ns,
+           Patient *patient) {
+    if (lane < 0 || lane >= NUM_QUEUE_LANES) {
+        return -1;
+    }
+    
+    pthread_mutex_lock(&queue->mutex);
+    
+    DoctorQueueHeap *heaps = queue->heaps[lane];
+    if (heaps[DQ_HEAP_SJF].size == 0) {
+        pthread_mutex_unlock(&queue->mutex);
+        return -1;
+    }
+    
+    // Limite de espera: o mais antigo passa à frente
+    int slot = heaps[DQ_HEAP_SJF].items[0];
+    int oldest = heaps[DQ_HEAP_FIFO].items[0];
+    if (max_wait_ns > 0 && now_ns - queue->slots[oldest].enqueue_ns >= max_wait_ns) {
+        slot = oldest;
+    }
+    
+    dq_heap_remove(queue, &heaps[DQ_HEAP_SJF], DQ_HEAP_SJF, slot);
+    dq_heap_remove(queue, &heaps[DQ_HEAP_FIFO], DQ_HEAP_FIFO, slot);
+    
+    memcpy(patient, &queue->slots[slot].patient, sizeof(Patient));
+    
+    queue->slots[slot].next_free = queue->free_head;
+    queue->free_head = slot;
+    
+    pthread_mutex_unlock(&queue->mutex);
+    return 0;
+}
+
+/*
+ * Instante de entrada do paciente mais antigo de uma lane
+ * Retorna -1 se a lane estiver vazia
+ */
+long long dq_oldest_enqueue_ns(DoctorQueue *queue, int lane) {
+    long long enqueued = -1;
+    
+    if (lane < 0 || lane >= NUM_QUEUE_LANES) {
+        return -1;
+    }
+    
+    pthread_mutex_lock(&queue->mutex);
+    DoctorQueueHeap *fifo = &queue->heaps[lane][DQ_HEAP_FIFO];
+    if (fifo->size > 0) {
+        enqueued = queue->slots[fifo->items[0]].enqueue_ns;
+    }
+    pthread_mutex_unlock(&queue->mutex);
+    
+    return enqueued;
+}
+
+/*
+ * Ordena posições da fila por instante de entrada (qsort)
+ */
+static int compare_enqueue_ns(const void *a, const void *b) {
+    long long ea = (*(DoctorQueueSlot * const *)a)->enqueue_ns;
+    long long eb = (*(DoctorQueueSlot * const *)b)->enqueue_ns;
+    return (ea > eb) - (ea < eb);
+}
+
+/*
+ * Copia os pacientes em fila (todas as lanes, por ordem de chegada de cada
+ * lane) para 'out', sem os retirar (checkpoint)
+ * Retorna o número de pacientes copiados
+ */
+int dq_snapshot(DoctorQueue *queue, Patient *out, int max) {
+    static DoctorQueueSlot *order[DQ_CAPACITY];   // Protegido pelo mutex da fila
+    int count = 0;
+    
+    pthread_mutex_lock(&queue->mutex);
+    for (int lane = 0; lane < NUM_QUEUE_LANES && count < max; lane++) {
+        DoctorQueueHeap *fifo = &queue->heaps[lane][DQ_HEAP_FIFO];
+        
+        // O array do heap não está por ordem de chegada
+        for (int i = 0; i < fifo->size; i++) {
+            order[i] = &queue->slots[fifo->items[i]];
+        }
+        qsort(order, fifo->size, sizeof(order[0]), compare_enqueue_ns);
+        
+        for (int i = 0; i < fifo->size && count < max; i++) {
+            memcpy(&out[count++], &order[i]->patient, sizeof(Patient));
+        }
+    }
+    pthread_mutex_unlock(&queue->mutex);
+    
+    return count;
+}
+
+/*
+ * Prazo (SLA, CLOCK_REALTIME em ns) do paciente mais antigo de uma lane
+ * Numa lane todos têm o mesmo alvo, por isso é também o prazo mais cedo
+ * Retorna -1 se a lane estiver vazia
+ */
+long long dq_oldest_deadline_ns(DoctorQueue *queue, int lane) {
+    long long deadline = -1;
+    
+    if (lane < 0 || lane >= NUM_QUEUE_LANES) {
+        return -1;
+    }
+    
+    pthread_mutex_lock(&queue->mutex);
+    DoctorQueueHeap *fifo = &queue->heaps[lane][DQ_HEAP_FIFO];
+    if (fifo->size > 0) {
+        const struct timespec *ts = &queue->slots[fifo->items[0]].patient.deadline;
+        deadline = (long long)ts->tv_sec * 1000000000LL + ts->tv_nsec;
+    }
+    pthread_mutex_unlock(&queue->mutex);
+    
+    return deadline;
+}
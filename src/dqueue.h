@@ -0,0 +1,55 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ */
+
+#ifndef DQUEUE_H
+#define DQUEUE_H
+
+#include <pthread.h>
+#include "patient.h"
+#include "config.h"
+
+#define DQ_CAPACITY 1024    // Pacientes em espera por atendimento (todas as prioridades)
+
+/* Índices dos dois heaps de cada lane (grupo x prioridade) */
+#define DQ_HEAP_SJF  0      // Ordenado por attendance_time (desempate por chegada)
+#define DQ_HEAP_FIFO 1      // Ordenado por chegada (para o limite de espera)
+
+/* Posição da pool de pacientes */
+typedef struct {
+    Patient patient;
+    long long enqueue_ns;       // Entrada na fila (CLOCK_MONOTONIC)
+    unsigned long long seq;     // Ordem de chegada
+    int heap_pos[2];            // Posição em cada heap (-1 = fora)
+    int next_free;              // Lista de posições livres
+} DoctorQueueSlot;
+
+/* Min-heap de índices de posições */
+typedef struct {
+    int items[DQ_CAPACITY];
+    int size;
+} DoctorQueueHeap;
+
+/* Fila de atendimento SJF em memória partilhada (alternativa à MSQ) */
+typedef struct {
+    pthread_mutex_t mutex;                  // PTHREAD_PROCESS_SHARED
+    DoctorQueueSlot slots[DQ_CAPACITY];
+    int free_head;                          // Primeira posição livre (-1 = cheia)
+    unsigned long long next_seq;
+    DoctorQueueHeap heaps[NUM_QUEUE_LANES][2];
+} DoctorQueue;
+
+/* Funções para a fila SJF */
+int dq_init(DoctorQueue *queue);
+void dq_destroy(DoctorQueue *queue);
+int dq_push(DoctorQueue *queue, int lane, const Patient *patient, long long now_ns);
+int dq_pop(DoctorQueue *queue, int lane, long long max_wait_ns, long long now_ns,
+           Patient *patient);
+long long dq_oldest_enqueue_ns(DoctorQueue *queue, int lane);
+long long dq_oldest_deadline_ns(DoctorQueue *queue, int lane);
+int dq_snapshot(DoctorQueue *queue, Patient *out, int max);
+
+#endif // DQUEUE_H
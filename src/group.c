@@ -0,0 +1,174 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "group.h"
+#include "shm.h"
+#include "msq.h"
+
+/*
+ * Lê DOCTOR_GROUPS: "none" (um só grupo) ou uma lista "a-b:n,..." em que
+ * cada grupo atende as prioridades a..b com n Doctors permanentes
+ * (ex.: "1-2:2,1-5:8" = 2 Doctors dedicados às prioridades 1-2)
+ * A soma dos n tem de ser DOCTORS e todas as prioridades têm de ter grupo
+ * Retorna 0 em caso de sucesso, -1 se a especificação for inválida
+ */
+int parse_doctor_groups(const char *spec, Config *config) {
+    if (spec[0] == '\0' || strcmp(spec, "none") == 0) {
+        config->num_groups = 1;
+        config->group_low[0] = 1;
+        config->group_high[0] = NUM_PRIORITIES;
+        config->group_doctors[0] = config->doctors;
+        return 0;
+    }
+    
+    const char *p = spec;
+    int count = 0;
+    int total = 0;
+    
+    while (*p != '\0') {
+        int low, high, doctors, used;
+        
+        if (count >= MAX_DOCTOR_GROUPS ||
+            sscanf(p, "%d-%d:%d%n", &low, &high, &doctors, &used) != 3) {
+            return -1;
+        }
+        if (low < 1 || high > NUM_PRIORITIES || low > high || doctors < 1) {
+            return -1;
+        }
+        
+        config->group_low[count] = low;
+        config->group_high[count] = high;
+        config->group_doctors[count] = doctors;
+        total += doctors;
+        count++;
+        
+        p += used;
+        if (*p == ',') {
+            p++;
+        } else if (*p != '\0') {
+            return -1;
+        }
+    }
+    
+    if (count == 0 || total != config->doctors) {
+        return -1;
+    }
+    
+    // Todas as prioridades têm de ser atendidas por algum grupo
+    for (int priority = 1; priority <= NUM_PRIORITIES; priority++) {
+        int covered = 0;
+        for (int g = 0; g < count; g++) {
+            if (priority >= config->group_low[g] && priority <= config->group_high[g]) {
+                covered = 1;
+            }
+        }
+        if (!covered) {
+            return -1;
+        }
+    }
+    
+    config->num_groups = count;
+    return 0;
+}
+
+/*
+ * Copia os grupos para a memória partilhada (chamado pelo Admission antes
+ * de lançar triagem e Doctors)
+ */
+void publish_doctor_groups(const Config *config) {
+    if (shm_stats == NULL) {
+        return;
+    }
+    
+    shm_stats->num_groups = config->num_groups;
+    for (int g = 0; g < config->num_groups; g++) {
+        shm_stats->group_low[g] = config->group_low[g];
+        shm_stats->group_high[g] = config->group_high[g];
+        shm_stats->group_doctors[g] = config->group_doctors[g];
+    }
+}
+
+/*
+ * Grupo de um Doctor permanente (índice 0..DOCTORS-1), pela ordem de
+ * DOCTOR_GROUPS
+ */
+int doctor_group_of(const Config *config, int doctor_index) {
+    for (int g = 0; g < config->num_groups; g++) {
+        if (doctor_index < config->group_doctors[g]) {
+            return g;
+        }
+        doctor_index -= config->group_doctors[g];
+    }
+    return config->num_groups - 1;
+}
+
+/*
+ * Carga de um grupo: pacientes nas suas lanes por Doctor permanente
+ */
+static double group_load(int group) {
+    int queued = 0;
+    for (int priority = 1; priority <= NUM_PRIORITIES; priority++) {
+        queued += get_lane_depth(group, priority);
+    }
+    return (double)queued / shm_stats->group_doctors[group];
+}
+
+/*
+ * Indica se um grupo atende uma prioridade
+ */
+int group_accepts(int group, int priority) {
+    return priority >= shm_stats->group_low[group] && priority <= shm_stats->group_high[group];
+}
+
+/*
+ * Grupo mais carregado (usado para colocar Doctors temporários)
+ */
+int most_loaded_group() {
+    int best = 0;
+    
+    if (shm_stats == NULL) {
+        return 0;
+    }
+    
+    for (int g = 1; g < shm_stats->num_groups; g++) {
+        if (group_load(g) > group_load(best)) {
+            best = g;
+        }
+    }
+    return best;
+}
+
+/*
+ * Escolhe o grupo menos carregado que atende a prioridade
+ * Em empate ganha o primeiro grupo (por ordem de DOCTOR_GROUPS)
+ */
+int route_patient_to_group(int priority) {
+    int best = -1;
+    double best_load = 0.0;
+    
+    if (shm_stats == NULL || shm_stats->num_groups <= 1) {
+        return 0;
+    }
+    
+    for (int g = 0; g < shm_stats->num_groups; g++) {
+        if (!group_accepts(g, priority)) {
+            continue;
+        }
+        
+        double load = group_load(g);
+        if (best < 0 || load < best_load) {
+            best = g;
+            best_load = load;
+        }
+    }
+    
+    return (best >= 0) ? best : 0;
+}
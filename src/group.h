@@ -0,0 +1,23 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ */
+
+#ifndef GROUP_H
+#define GROUP_H
+
+#include "config.h"
+
+/* Funções para configuração dos grupos de Doctors (DOCTOR_GROUPS) */
+int parse_doctor_groups(const char *spec, Config *config);
+void publish_doctor_groups(const Config *config);
+
+/* Funções usadas pela triagem e pelos Doctors */
+int doctor_group_of(const Config *config, int doctor_index);
+int most_loaded_group();
+int route_patient_to_group(int priority);
+int group_accepts(int group, int priority);
+
+#endif // GROUP_H
@@ -0,0 +1,691 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ *
+ * Gerador de carga: envia pacientes para o Admission (named pipe de texto,
+ * named pipe binário ou socket de ingestão) segundo um processo de chegadas
+ * (Poisson, MMPP de dois estados ou trace), com ritmo absoluto (sem deriva)
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "pipe.h"
+#include "sock.h"
+
+#define LOADGEN_DEFAULT_BATCH 1024      // Registos por frame (ou linhas por write)
+#define LOADGEN_TEXT_CHUNK 4096         // PIPE_BUF: writes de texto atómicos
+#define LOADGEN_ACK_TIMEOUT_MS 2000     // Espera pelos ACKs em falta no fim
+#define LOADGEN_MAX_TRACE 1000000       // Entradas máximas de um trace
+
+/* Transportes */
+#define TRANSPORT_TEXT   0
+#define TRANSPORT_BATCH  1
+#define TRANSPORT_SOCKET 2
+
+/* Processos de chegada */
+#define ARRIVAL_POISSON 0
+#define ARRIVAL_MMPP    1
+#define ARRIVAL_TRACE   2
+
+/* Distribuições de tempos (triagem e atendimento) */
+#define DIST_CONST   0
+#define DIST_EXP     1
+#define DIST_UNIFORM 2
+
+typedef struct {
+    int kind;
+    double a;       // Valor (const), média (exp) ou mínimo (uniform)
+    double b;       // Máximo (uniform)
+} Distribution;
+
+/* Entrada de um trace: "offset_ms prioridade triagem_ms atendimento_ms" */
+typedef struct {
+    long long offset_ns;
+    int priority;
+    int triage_time;
+    int attendance_time;
+} TraceEntry;
+
+/* Opções da linha de comandos */
+typedef struct {
+    int transport;
+    int arrival;
+    double rate;                    // Pacientes/s (Poisson, estado calmo do MMPP)
+    double burst_rate;              // Pacientes/s no estado de pico do MMPP
+    double quiet_ms;                // Duração média do estado calmo
+    double burst_ms;                // Duração média do estado de pico
+    double duration_s;
+    long max_patients;              // 0 = sem limite
+    int batch;
+    double mix[5];                  // Pesos das prioridades 1-5
+    Distribution triage;
+    Distribution attendance;
+    const char *trace_file;
+    double trace_speed;             // Fator de aceleração do trace
+    uint64_t seed;
+    int frontend;                   // 0 = coordenador, N = front-end N (modo scale-out)
+} LoadgenOptions;
+
+/* Estatísticas do envio */
+typedef struct {
+    long sent;
+    long frames;
+    long write_errors;
+    long long max_lag_ns;           // Maior atraso de um envio face ao instante previsto
+    long acks;                      // Só socket
+    long accepted;
+    long dropped;
+    long rejected;
+} LoadgenStats;
+
+static volatile sig_atomic_t stop_requested = 0;
+static uint64_t rng_state;
+
+/* Handler para SIGINT: parar e imprimir o relatório */
+static void sigint_handler(int signum) {
+    (void)signum;
+    stop_requested = 1;
+}
+
+/*
+ * Gerador pseudo-aleatório xorshift64* (reprodutível com -S)
+ */
+static uint64_t rng_next() {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 2685821657736338717ULL;
+}
+
+/*
+ * Uniforme em (0, 1]
+ */
+static double rng_uniform() {
+    return ((rng_next() >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+/*
+ * Amostra exponencial com a média indicada
+ */
+static double rng_exponential(double mean) {
+    return -log(rng_uniform()) * mean;
+}
+
+static long long monotonic_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/*
+ * Lê uma distribuição: "const:X", "exp:MEDIA" ou "uniform:MIN-MAX" (ms)
+ * Retorna 0 em caso de sucesso, -1 se for inválida
+ */
+static int parse_distribution(const char *spec, Distribution *dist) {
+    if (sscanf(spec, "const:%lf", &dist->a) == 1) {
+        dist->kind = DIST_CONST;
+    } else if (sscanf(spec, "exp:%lf", &dist->a) == 1) {
+        dist->kind = DIST_EXP;
+    } else if (sscanf(spec, "uniform:%lf-%lf", &dist->a, &dist->b) == 2 && dist->b >= dist->a) {
+        dist->kind = DIST_UNIFORM;
+    } else {
+        return -1;
+    }
+    return (dist->a > 0) ? 0 : -1;
+}
+
+/*
+ * Amostra um tempo em ms, limitado ao intervalo aceite pelo Admission
+ */
+static int sample_time(const Distribution *dist, int max_ms) {
+    double value;
+    
+    switch (dist->kind) {
+        case DIST_EXP:     value = rng_exponential(dist->a); break;
+        case DIST_UNIFORM: value = dist->a + (dist->b - dist->a) * rng_uniform(); break;
+        default:           value = dist->a; break;
+    }
+    
+    int ms = (int)(value + 0.5);
+    if (ms < 1) {
+        ms = 1;
+    }
+    return (ms > max_ms) ? max_ms : ms;
+}
+
+/*
+ * Prioridade segundo os pesos de -m
+ */
+static int sample_priority(const double mix[5]) {
+    double total = mix[0] + mix[1] + mix[2] + mix[3] + mix[4];
+    double u = rng_uniform() * total;
+    
+    for (int p = 0; p < 4; p++) {
+        if (u <= mix[p]) {
+            return p + 1;
+        }
+        u -= mix[p];
+    }
+    return 5;
+}
+
+/*
+ * Lê um trace ("offset_ms prioridade triagem_ms atendimento_ms" por linha,
+ * '#' para comentários); os offsets são divididos por 'speed'
+ * Retorna o número de entradas, ou -1 em caso de erro
+ */
+static int load_trace(const char *filename, double speed, TraceEntry **entries) {
+    FILE *file = fopen(filename, "r");
+    if (file == NULL) {
+        perror("Erro ao abrir trace");
+        return -1;
+    }
+    
+    int capacity = 1024;
+    int count = 0;
+    *entries = malloc(capacity * sizeof(TraceEntry));
+    if (*entries == NULL) {
+        perror("Erro ao alocar memória para o trace");
+        fclose(file);
+        return -1;
+    }
+    
+    char line[256];
+    while (fgets(line, sizeof(line), file) != NULL && count < LOADGEN_MAX_TRACE) {
+        double offset_ms;
+        TraceEntry entry;
+        
+        if (line[0] == '#' || sscanf(line, "%lf %d %d %d", &offset_ms, &entry.priority,
+                                     &entry.triage_time, &entry.attendance_time) != 4) {
+            continue;
+        }
+        
+        if (count == capacity) {
+            capacity *= 2;
+            TraceEntry *grown = realloc(*entries, capacity * sizeof(TraceEntry));
+            if (grown == NULL) {
+                perror("Erro ao alocar memória para o trace");
+                free(*entries);
+                fclose(file);
+                return -1;
+            }
+            *entries = grown;
+        }
+        
+        entry.offset_ns = (long long)(offset_ms / speed * 1e6);
+        (*entries)[count++] = entry;
+    }
+    
+    fclose(file);
+    return count;
+}
+
+/*
+ * Estado do processo de chegadas
+ */
+typedef struct {
+    long long next_ns;              // Instante (relativo ao início) da próxima chegada
+    int burst;                      // MMPP: 1 = estado de pico
+    long long state_end_ns;         // MMPP: fim do estado atual
+    TraceEntry *trace;
+    int trace_count;
+    int trace_pos;
+} ArrivalState;
+
+/*
+ * Avança para a chegada seguinte
+ * Retorna 0, ou -1 se o processo terminou (fim do trace)
+ */
+static int next_arrival(const LoadgenOptions *opts, ArrivalState *state) {
+    if (opts->arrival == ARRIVAL_TRACE) {
+        if (++state->trace_pos >= state->trace_count) {
+            return -1;
+        }
+        state->next_ns = state->trace[state->trace_pos].offset_ns;
+        return 0;
+    }
+    
+    if (opts->arrival == ARRIVAL_POISSON) {
+        state->next_ns += (long long)(rng_exponential(1e9 / opts->rate));
+        return 0;
+    }
+    
+    // MMPP: chegadas de Poisson à taxa do estado; sem memória, por isso ao
+    // mudar de estado basta recomeçar a amostragem a partir da mudança
+    long long t = state->next_ns;
+    while (1) {
+        double rate = state->burst ? opts->burst_rate : opts->rate;
+        long long candidate = t + (long long)(rng_exponential(1e9 / rate));
+        
+        if (candidate <= state->state_end_ns) {
+            state->next_ns = candidate;
+            return 0;
+        }
+        
+        t = state->state_end_ns;
+        state->burst = !state->burst;
+        double mean_ms = state->burst ? opts->burst_ms : opts->quiet_ms;
+        state->state_end_ns = t + (long long)(rng_exponential(mean_ms * 1e6));
+    }
+}
+
+/*
+ * Lê os ACKs disponíveis no socket ("ACK aceites descartados rejeitados")
+ * Com wait_ms > 0 espera até esse tempo pelo primeiro
+ */
+static void read_acks(int fd, LoadgenStats *stats, int wait_ms) {
+    char ack[SOCKET_ACK_SIZE];
+    
+    if (wait_ms > 0) {
+        struct timeval tv = {wait_ms / 1000, (wait_ms % 1000) * 1000};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    }
+    
+    while (1) {
+        ssize_t n = recv(fd, ack, sizeof(ack) - 1, (wait_ms > 0) ? 0 : MSG_DONTWAIT);
+        if (n <= 0) {
+            return;
+        }
+        
+        ack[n] = '\0';
+        int accepted, dropped, rejected;
+        if (sscanf(ack, "ACK %d %d %d", &accepted, &dropped, &rejected) == 3) {
+            stats->acks++;
+            stats->accepted += accepted;
+            stats->dropped += dropped;
+            stats->rejected += rejected;
+        }
+        
+        if (wait_ms > 0) {
+            return;
+        }
+    }
+}
+
+/*
+ * Escreve 'length' bytes, repetindo em caso de escrita parcial
+ * Retorna 0 em caso de sucesso, -1 em caso de erro
+ */
+static int write_all(int fd, const void *data, size_t length) {
+    const char *p = data;
+    
+    while (length > 0) {
+        ssize_t n = write(fd, p, length);
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        p += n;
+        length -= (size_t)n;
+    }
+    return 0;
+}
+
+/*
+ * Envia um lote de registos pelo transporte escolhido
+ * Retorna 0 em caso de sucesso, -1 em caso de erro
+ */
+static int send_records(int fd, int transport, const BatchRecord *records, int count,
+                        unsigned char *buffer, LoadgenStats *stats) {
+    if (transport == TRANSPORT_TEXT) {
+        // Linhas "nome triagem atendimento prioridade" agrupadas até PIPE_BUF
+        size_t length = 0;
+        for (int i = 0; i < count; i++) {
+            char line[96];
+            int n = snprintf(line, sizeof(line), "LG%ld %d %d %d\n", stats->sent + i,
+                             records[i].triage_time, records[i].attendance_time, records[i].priority);
+            if (length + n > LOADGEN_TEXT_CHUNK) {
+                if (write_all(fd, buffer, length) != 0) {
+                    return -1;
+                }
+                stats->frames++;
+                length = 0;
+            }
+            memcpy(buffer + length, line, n);
+            length += n;
+        }
+        if (length > 0) {
+            if (write_all(fd, buffer, length) != 0) {
+                return -1;
+            }
+            stats->frames++;
+        }
+        return 0;
+    }
+    
+    BatchHeader header = {BATCH_MAGIC, (uint32_t)count};
+    memcpy(buffer, &header, sizeof(header));
+    memcpy(buffer + sizeof(header), records, count * sizeof(BatchRecord));
+    size_t length = sizeof(header) + count * sizeof(BatchRecord);
+    
+    if (transport == TRANSPORT_SOCKET) {
+        if (send(fd, buffer, length, MSG_NOSIGNAL) == -1) {
+            return -1;
+        }
+        stats->frames++;
+        read_acks(fd, stats, 0);
+        return 0;
+    }
+    
+    if (write_all(fd, buffer, length) != 0) {
+        return -1;
+    }
+    stats->frames++;
+    return 0;
+}
+
+/*
+ * Abre o destino do transporte (os front-ends usam "nome.N", ver scaleout.c)
+ * Retorna o descritor, ou -1 em caso de erro
+ */
+static int open_transport(int transport, int frontend) {
+    char name[256];
+    
+    if (transport == TRANSPORT_SOCKET) {
+        int fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+        if (fd == -1) {
+            perror("Erro ao criar socket");
+            return -1;
+        }
+        
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        int length = (frontend > 0) ?
+            snprintf(addr.sun_path, sizeof(addr.sun_path), "%s.%d", SOCKET_NAME, frontend) :
+            snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", SOCKET_NAME);
+        if (length >= (int)sizeof(addr.sun_path)) {
+            fprintf(stderr, "ERRO: Caminho do socket demasiado longo\n");
+            close(fd);
+            return -1;
+        }
+        
+        if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+            perror("Erro ao ligar ao socket de ingestão");
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+    
+    const char *base = (transport == TRANSPORT_TEXT) ? PIPE_NAME : BATCH_PIPE_NAME;
+    if (frontend > 0) {
+        snprintf(name, sizeof(name), "%s.%d", base, frontend);
+    } else {
+        snprintf(name, sizeof(name), "%s", base);
+    }
+    int fd = open(name, O_WRONLY);
+    if (fd == -1) {
+        perror("Erro ao abrir named pipe");
+    }
+    return fd;
+}
+
+static void print_usage(const char *program) {
+    fprintf(stderr,
+        "Uso: %s [opções]\n"
+        "  -t text|batch|socket   transporte (omissão: batch)\n"
+        "  -a poisson|mmpp|trace  processo de chegadas (omissão: poisson)\n"
+        "  -r TAXA                pacientes/s (Poisson; estado calmo do MMPP)\n"
+        "  -R TAXA                pacientes/s no estado de pico do MMPP\n"
+        "  -q MS / -u MS          duração média do estado calmo / de pico (MMPP)\n"
+        "  -f FICHEIRO            trace: \"offset_ms prioridade triagem_ms atendimento_ms\"\n"
+        "  -x FATOR               acelera o trace (omissão: 1)\n"
+        "  -d SEGUNDOS            duração (omissão: 10)\n"
+        "  -n N                   número máximo de pacientes\n"
+        "  -m P1,P2,P3,P4,P5      pesos das prioridades (omissão: 10,20,30,25,15)\n"
+        "  -T DIST / -A DIST      tempo de triagem / atendimento em ms:\n"
+        "                         const:X, exp:MEDIA, uniform:MIN-MAX\n"
+        "                         (omissão: const:10 / exp:50)\n"
+        "  -b N                   pacientes por frame (omissão: %d)\n"
+        "  -S SEMENTE             semente do gerador aleatório\n"
+        "  -F N                   enviar para o front-end N (modo scale-out)\n",
+        program, LOADGEN_DEFAULT_BATCH);
+}
+
+/*
+ * Lê as opções da linha de comandos
+ * Retorna 0 em caso de sucesso, -1 se forem inválidas
+ */
+static int parse_options(int argc, char *argv[], LoadgenOptions *opts) {
+    opts->transport = TRANSPORT_BATCH;
+    opts->arrival = ARRIVAL_POISSON;
+    opts->rate = 1000;
+    opts->burst_rate = 10000;
+    opts->quiet_ms = 1000;
+    opts->burst_ms = 200;
+    opts->duration_s = 10;
+    opts->max_patients = 0;
+    opts->batch = LOADGEN_DEFAULT_BATCH;
+    double default_mix[5] = {10, 20, 30, 25, 15};
+    memcpy(opts->mix, default_mix, sizeof(default_mix));
+    parse_distribution("const:10", &opts->triage);
+    parse_distribution("exp:50", &opts->attendance);
+    opts->trace_file = NULL;
+    opts->trace_speed = 1.0;
+    opts->seed = 42;
+    opts->frontend = 0;
+    
+    int opt;
+    while ((opt = getopt(argc, argv, "t:a:r:R:q:u:f:x:d:n:m:T:A:b:S:F:h")) != -1) {
+        switch (opt) {
+            case 't':
+                if (strcmp(optarg, "text") == 0) opts->transport = TRANSPORT_TEXT;
+                else if (strcmp(optarg, "batch") == 0) opts->transport = TRANSPORT_BATCH;
+                else if (strcmp(optarg, "socket") == 0) opts->transport = TRANSPORT_SOCKET;
+                else return -1;
+                break;
+            case 'a':
+                if (strcmp(optarg, "poisson") == 0) opts->arrival = ARRIVAL_POISSON;
+                else if (strcmp(optarg, "mmpp") == 0) opts->arrival = ARRIVAL_MMPP;
+                else if (strcmp(optarg, "trace") == 0) opts->arrival = ARRIVAL_TRACE;
+                else return -1;
+                break;
+            case 'r': opts->rate = atof(optarg); break;
+            case 'R': opts->burst_rate = atof(optarg); break;
+            case 'q': opts->quiet_ms = atof(optarg); break;
+            case 'u': opts->burst_ms = atof(optarg); break;
+            case 'f': opts->trace_file = optarg; break;
+            case 'x': opts->trace_speed = atof(optarg); break;
+            case 'd': opts->duration_s = atof(optarg); break;
+            case 'n': opts->max_patients = atol(optarg); break;
+            case 'm':
+                if (sscanf(optarg, "%lf,%lf,%lf,%lf,%lf", &opts->mix[0], &opts->mix[1],
+                           &opts->mix[2], &opts->mix[3], &opts->mix[4]) != 5) {
+                    return -1;
+                }
+                break;
+            case 'T':
+                if (parse_distribution(optarg, &opts->triage) != 0) return -1;
+                break;
+            case 'A':
+                if (parse_distribution(optarg, &opts->attendance) != 0) return -1;
+                break;
+            case 'b': opts->batch = atoi(optarg); break;
+            case 'S': opts->seed = strtoull(optarg, NULL, 10); break;
+            case 'F': opts->frontend = atoi(optarg); break;
+            default:
+                return -1;
+        }
+    }
+    
+    int max_batch = (SOCKET_MAX_MESSAGE - (int)sizeof(BatchHeader)) / (int)sizeof(BatchRecord);
+    if (opts->rate <= 0 || opts->burst_rate <= 0 || opts->quiet_ms <= 0 || opts->burst_ms <= 0 ||
+        opts->duration_s <= 0 || opts->trace_speed <= 0 || opts->batch < 1 || opts->batch > max_batch ||
+        opts->frontend < 0) {
+        return -1;
+    }
+    if (opts->arrival == ARRIVAL_TRACE && opts->trace_file == NULL) {
+        return -1;
+    }
+    for (int p = 0; p < 5; p++) {
+        if (opts->mix[p] < 0) {
+            return -1;
+        }
+    }
+    
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    LoadgenOptions opts;
+    if (parse_options(argc, argv, &opts) != 0) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    rng_state = opts.seed ? opts.seed : 1;
+    
+    ArrivalState state;
+    memset(&state, 0, sizeof(state));
+    state.trace_pos = -1;
+    
+    if (opts.arrival == ARRIVAL_TRACE) {
+        state.trace_count = load_trace(opts.trace_file, opts.trace_speed, &state.trace);
+        if (state.trace_count <= 0) {
+            fprintf(stderr, "ERRO: Trace vazio ou inválido\n");
+            return EXIT_FAILURE;
+        }
+    } else if (opts.arrival == ARRIVAL_MMPP) {
+        state.state_end_ns = (long long)(rng_exponential(opts.quiet_ms * 1e6));
+    }
+    
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = sigint_handler;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+    
+    int fd = open_transport(opts.transport, opts.frontend);
+    if (fd == -1) {
+        free(state.trace);
+        return EXIT_FAILURE;
+    }
+    
+    BatchRecord *records = calloc(opts.batch, sizeof(BatchRecord));
+    size_t buffer_size = sizeof(BatchHeader) + opts.batch * sizeof(BatchRecord);
+    if (buffer_size < LOADGEN_TEXT_CHUNK) {
+        buffer_size = LOADGEN_TEXT_CHUNK;
+    }
+    unsigned char *buffer = malloc(buffer_size);
+    if (records == NULL || buffer == NULL) {
+        perror("Erro ao alocar buffers");
+        close(fd);
+        return EXIT_FAILURE;
+    }
+    
+    LoadgenStats stats;
+    memset(&stats, 0, sizeof(stats));
+    
+    long long duration_ns = (long long)(opts.duration_s * 1e9);
+    int finished = (next_arrival(&opts, &state) != 0);
+    long long start = monotonic_ns();
+    
+    // Ciclo de envio: junta num frame todas as chegadas já devidas e dorme
+    // até à seguinte (instantes absolutos, para o ritmo não derivar)
+    while (!finished && !stop_requested) {
+        long long now = monotonic_ns() - start;
+        
+        if (state.next_ns > now) {
+            struct timespec until;
+            long long target = start + state.next_ns;
+            until.tv_sec = target / 1000000000LL;
+            until.tv_nsec = target % 1000000000LL;
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL);
+            now = monotonic_ns() - start;
+        }
+        
+        int count = 0;
+        while (count < opts.batch && state.next_ns <= now) {
+            if (state.next_ns >= duration_ns ||
+                (opts.max_patients > 0 && stats.sent + count >= opts.max_patients)) {
+                finished = 1;
+                break;
+            }
+            
+            BatchRecord *record = &records[count++];
+            memset(record->name, 0, sizeof(record->name));   // Nome gerado pelo Admission
+            if (opts.arrival == ARRIVAL_TRACE) {
+                TraceEntry *entry = &state.trace[state.trace_pos];
+                record->priority = entry->priority;
+                record->triage_time = entry->triage_time;
+                record->attendance_time = entry->attendance_time;
+            } else {
+                record->priority = sample_priority(opts.mix);
+                record->triage_time = sample_time(&opts.triage, 10000);
+                record->attendance_time = sample_time(&opts.attendance, 100000);
+            }
+            
+            if (now - state.next_ns > stats.max_lag_ns) {
+                stats.max_lag_ns = now - state.next_ns;
+            }
+            
+            if (next_arrival(&opts, &state) != 0) {
+                finished = 1;
+                break;
+            }
+        }
+        
+        if (count > 0) {
+            if (send_records(fd, opts.transport, records, count, buffer, &stats) != 0) {
+                perror("Erro ao enviar pacientes");
+                stats.write_errors++;
+                break;
+            }
+            stats.sent += count;
+        }
+    }
+    
+    double elapsed = (monotonic_ns() - start) / 1e9;
+    
+    // No socket cada frame tem um ACK: esperar pelos que faltam
+    if (opts.transport == TRANSPORT_SOCKET) {
+        long long deadline = monotonic_ns() + LOADGEN_ACK_TIMEOUT_MS * 1000000LL;
+        while (stats.acks < stats.frames && monotonic_ns() < deadline) {
+            read_acks(fd, &stats, 100);
+        }
+    }
+    
+    double target_rate = (opts.arrival == ARRIVAL_TRACE) ? 0.0 : opts.rate;
+    
+    printf("=== Gerador de carga ===\n");
+    printf("Enviados: %ld pacientes em %ld frames, %.3f s\n", stats.sent, stats.frames, elapsed);
+    if (target_rate > 0 && opts.arrival == ARRIVAL_POISSON) {
+        printf("Taxa: alvo %.0f/s, obtida %.0f/s\n", target_rate, stats.sent / elapsed);
+    } else {
+        printf("Taxa obtida: %.0f/s\n", stats.sent / elapsed);
+    }
+    printf("Atraso máximo face ao ritmo previsto: %.3f ms\n", stats.max_lag_ns / 1e6);
+    if (opts.transport == TRANSPORT_SOCKET) {
+        printf("ACKs: %ld/%ld | aceites: %ld | descartados: %ld | rejeitados: %ld\n",
+               stats.acks, stats.frames, stats.accepted, stats.dropped, stats.rejected);
+    } else {
+        printf("Descartados: só conhecidos com -t socket (ACK por frame)\n");
+    }
+    if (stats.write_errors > 0) {
+        printf("Envio interrompido por erro\n");
+    }
+    
+    free(records);
+    free(buffer);
+    free(state.trace);
+    close(fd);
+    
+    return (stats.write_errors > 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,194 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ */
+
+#include <stdio.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/mman.h>
+#include "lockstat.h"
+#include "timeline.h"
+#include "log.h"
+
+#define DEBUG
+
+/* Tipo do intervalo de espera na linha temporal, por lock */
+static const int lock_timeline_kinds[NUM_LOCKS] = {
+    TL_LOCK_LOG, TL_LOCK_QUEUE, TL_LOCK_CONTROL, TL_LOCK_STATS
+};
+
+#ifdef LOCKSTAT
+static const char *lock_names[NUM_LOCKS] = {
+    "log_mutex", "triage_queue->mutex", "triage_control_mutex", "shm_stats->mutex"
+};
+
+/* Contadores em memória anónima partilhada (os Doctors herdam-na no fork) */
+static LockStats *lock_stats = NULL;
+
+static int wait_bucket(long long wait_ns) {
+    long long wait_us = wait_ns / 1000;
+    if (wait_us < 1) {
+        return 0;
+    }
+    int bucket = 64 - __builtin_clzll((unsigned long long)wait_us);
+    return (bucket < LOCKSTAT_HIST_BUCKETS) ? bucket : LOCKSTAT_HIST_BUCKETS - 1;
+}
+
+/* Limite superior (µs) do balde 'bucket' */
+static long long bucket_limit_us(int bucket) {
+    return 1LL << bucket;
+}
+
+static void record_wait(int lock_id, long long wait_ns) {
+    LockStats *stats = &lock_stats[lock_id];
+    atomic_fetch_add_explicit(&stats->contended, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&stats->wait_ns, wait_ns, memory_order_relaxed);
+    atomic_fetch_add_explicit(&stats->wait_hist[wait_bucket(wait_ns)], 1, memory_order_relaxed);
+    
+    long long max = atomic_load_explicit(&stats->max_wait_ns, memory_order_relaxed);
+    while (wait_ns > max &&
+           !atomic_compare_exchange_weak_explicit(&stats->max_wait_ns, &max, wait_ns,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+/* Espera (µs) abaixo da qual está a fração 'fraction' das esperas */
+static long long hist_percentile_us(const LockStats *stats, long contended, double fraction) {
+    long target = (long)(contended * fraction);
+    long seen = 0;
+    for (int b = 0; b < LOCKSTAT_HIST_BUCKETS; b++) {
+        seen += atomic_load_explicit(&stats->wait_hist[b], memory_order_relaxed);
+        if (seen > target) {
+            return bucket_limit_us(b);
+        }
+    }
+    return bucket_limit_us(LOCKSTAT_HIST_BUCKETS - 1);
+}
+#endif
+
+/*
+ * Mapeia os contadores; tem de ser chamado antes de criar threads e Doctors
+ * Retorna 0 em caso de sucesso, -1 em caso de erro
+ */
+int open_lockstat() {
+    #ifdef LOCKSTAT
+    LockStats *stats = mmap(NULL, NUM_LOCKS * sizeof(LockStats), PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (stats == MAP_FAILED) {
+        perror("Erro ao mapear contadores de locks");
+        return -1;
+    }
+    lock_stats = stats;   // mmap anónimo já vem a zeros
+    
+    #ifdef DEBUG
+    printf("[DEBUG] Contadores de contenção mapeados (%d locks)\n", NUM_LOCKS);
+    #endif
+    #endif
+    
+    return 0;
+}
+
+int lock_mutex(pthread_mutex_t *mutex, int lock_id) {
+    #ifndef LOCKSTAT
+    if (!timeline_enabled()) {
+        return pthread_mutex_lock(mutex);
+    }
+    #endif
+    
+    // Caso sem contenção: só o trylock
+    int result = pthread_mutex_trylock(mutex);
+    if (result != EBUSY) {
+        #ifdef LOCKSTAT
+        if (result == 0 && lock_stats != NULL) {
+            atomic_fetch_add_explicit(&lock_stats[lock_id].acquisitions, 1, memory_order_relaxed);
+        }
+        #endif
+        return result;
+    }
+    
+    struct timespec start, end;
+    clock_gettime(CLOCK_REALTIME, &start);
+    result = pthread_mutex_lock(mutex);
+    clock_gettime(CLOCK_REALTIME, &end);
+    if (result != 0) {
+        return result;
+    }
+    
+    #ifdef LOCKSTAT
+    if (lock_stats != NULL) {
+        atomic_fetch_add_explicit(&lock_stats[lock_id].acquisitions, 1, memory_order_relaxed);
+        record_wait(lock_id, (end.tv_sec - start.tv_sec) * 1000000000LL +
+                             (end.tv_nsec - start.tv_nsec));
+    }
+    #endif
+    
+    timeline_record(lock_timeline_kinds[lock_id], 0, &start, &end);
+    return 0;
+}
+
+/*
+ * Tabela de contenção por lock (SIGUSR1 e fim do programa)
+ * p50 e p99 vêm do histograma (limite superior do balde)
+ */
+void print_lockstat() {
+    #ifdef LOCKSTAT
+    if (lock_stats == NULL) {
+        return;
+    }
+    
+    printf("Contenção de locks (lock_mutex; esperas em µs):\n");
+    printf("  %-22s %12s %12s %7s %12s %9s %9s %9s %10s\n", "lock", "aquisições",
+           "contendidas", "%", "espera (ms)", "média", "p50", "p99", "máx");
+    
+    for (int i = 0; i < NUM_LOCKS; i++) {
+        const LockStats *stats = &lock_stats[i];
+        long acquisitions = atomic_load_explicit(&stats->acquisitions, memory_order_relaxed);
+        long contended = atomic_load_explicit(&stats->contended, memory_order_relaxed);
+        long long wait_ns = atomic_load_explicit(&stats->wait_ns, memory_order_relaxed);
+        long long max_wait_ns = atomic_load_explicit(&stats->max_wait_ns, memory_order_relaxed);
+        
+        double percent = (acquisitions > 0) ? 100.0 * contended / acquisitions : 0.0;
+        double mean_us = (contended > 0) ? wait_ns / 1e3 / contended : 0.0;
+        long long p50 = (contended > 0) ? hist_percentile_us(stats, contended, 0.50) : 0;
+        long long p99 = (contended > 0) ? hist_percentile_us(stats, contended, 0.99) : 0;
+        
+        printf("  %-22s %12ld %12ld %6.2f%% %12.3f %9.1f %9lld %9lld %10.1f\n", lock_names[i],
+               acquisitions, contended, percent, wait_ns / 1e6, mean_us, p50, p99,
+               max_wait_ns / 1e3);
+        
+        if (contended == 0) {
+            continue;
+        }
+        
+        // Histograma: só os baldes com esperas, "<limite:contagem"
+        printf("  %-22s", "");
+        for (int b = 0; b < LOCKSTAT_HIST_BUCKETS; b++) {
+            long count = atomic_load_explicit(&stats->wait_hist[b], memory_order_relaxed);
+            if (count == 0) {
+                continue;
+            }
+            if (b == LOCKSTAT_HIST_BUCKETS - 1) {
+                printf(" >=%lld:%ld", bucket_limit_us(b - 1), count);
+            } else {
+                printf(" <%lld:%ld", bucket_limit_us(b), count);
+            }
+        }
+        printf("\n");
+    }
+    printf("\n");
+    
+    // No log depois da tabela (write_log também escreve no stdout)
+    for (int i = 0; i < NUM_LOCKS; i++) {
+        const LockStats *stats = &lock_stats[i];
+        long acquisitions = atomic_load_explicit(&stats->acquisitions, memory_order_relaxed);
+        long contended = atomic_load_explicit(&stats->contended, memory_order_relaxed);
+        write_log("Lock %s: %ld aquisições, %ld contendidas, espera %.3f ms (máx %.1f µs)",
+                  lock_names[i], acquisitions, contended,
+                  atomic_load_explicit(&stats->wait_ns, memory_order_relaxed) / 1e6,
+                  atomic_load_explicit(&stats->max_wait_ns, memory_order_relaxed) / 1e3);
+    }
+    #endif
+}
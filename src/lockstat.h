@@ -0,0 +1,43 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ */
+
+#ifndef LOCKSTAT_H
+#define LOCKSTAT_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+/* Locks instrumentados (os que cada paciente atravessa) */
+#define LOCK_LOG             0  // log_mutex (log.c)
+#define LOCK_TRIAGE_QUEUE    1  // triage_queue->mutex (triage.c)
+#define LOCK_TRIAGE_CONTROL  2  // triage_control_mutex (triage.c)
+#define LOCK_SHM_STATS       3  // shm_stats->mutex (shm.c, partilhado com os Doctors)
+#define NUM_LOCKS            4
+
+/* Histograma da espera: 0 = < 1 µs, i = [2^(i-1), 2^i) µs, o último acumula o resto */
+#define LOCKSTAT_HIST_BUCKETS 24
+
+/* Contadores de um lock (só compilados com make lockstat, -DLOCKSTAT) */
+typedef struct {
+    _Alignas(64) atomic_long acquisitions;  // Todas as aquisições por lock_mutex
+    atomic_long contended;                  // Aquisições em que o mutex estava ocupado
+    atomic_llong wait_ns;                   // Espera total das contendidas
+    atomic_llong max_wait_ns;
+    atomic_long wait_hist[LOCKSTAT_HIST_BUCKETS];
+} LockStats;
+
+/* Funções para os contadores de contenção (sem -DLOCKSTAT não fazem nada) */
+int open_lockstat();
+void print_lockstat();
+
+/*
+ * pthread_mutex_lock instrumentado: com -DLOCKSTAT conta aquisições,
+ * contenção e espera; com a linha temporal ativa regista também a espera
+ */
+int lock_mutex(pthread_mutex_t *mutex, int lock_id);
+
+#endif // LOCKSTAT_H
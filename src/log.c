@@ -16,6 +16,10 @@
 #include <sys/stat.h>
 #include <pthread.h>
 #include "log.h"
+#include "affinity.h"
+#include "timeline.h"
+#include "lockstat.h"
+#include "scaleout.h"
 
 #define DEBUG 
 
@@ -24,23 +28,41 @@ char *log_buffer = NULL;
 size_t log_current_pos = 0;
 int log_fd = -1;
 
+/* Ficheiro de log desta instância ("base.N" nos front-ends) */
+static char log_path[INSTANCE_NAME_MAX] = LOG_FILENAME;
+
 /* Mutex para sincronização de escrita no log */
 static pthread_mutex_t log_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+/*
+ * fork() com threads: o Admission cria Doctors enquanto as threads de
+ * triagem escrevem no log. Sem isto, um filho criado com o log_mutex
+ * adquirido por outra thread herda-o fechado e bloqueia no primeiro write_log
+ */
+static void log_prepare_fork() {
+    pthread_mutex_lock(&log_mutex);
+}
+
+static void log_after_fork() {
+    pthread_mutex_unlock(&log_mutex);
+}
+
 /*
  * Cria e mapeia o ficheiro de log em memória
  * Retorna 0 em caso de sucesso, -1 em caso de erro
  */
 int create_log_file() {
+    instance_name(LOG_FILENAME, log_path, sizeof(log_path));
+    
     #ifdef DEBUG
     printf("[DEBUG] A criar ficheiro de log mapeado em memória...\n");
     #endif
     
     // Remover ficheiro anterior (se existir)
-    unlink(LOG_FILENAME);
+    unlink(log_path);
     
     // Criar ficheiro de log
-    log_fd = open(LOG_FILENAME, O_RDWR | O_CREAT | O_TRUNC, 0666);
+    log_fd = open(log_path, O_RDWR | O_CREAT | O_TRUNC, 0666);
     if (log_fd == -1) {
         perror("Erro ao criar ficheiro de log");
         return -1;
@@ -50,7 +72,7 @@ int create_log_file() {
     if (ftruncate(log_fd, LOG_FILE_SIZE) == -1) {
         perror("Erro ao definir tamanho do ficheiro de log");
         close(log_fd);
-        unlink(LOG_FILENAME);
+        unlink(log_path);
         return -1;
     }
     
@@ -60,11 +82,14 @@ int create_log_file() {
     if (log_buffer == MAP_FAILED) {
         perror("Erro ao mapear ficheiro de log em memória");
         close(log_fd);
-        unlink(LOG_FILENAME);
+        unlink(log_path);
         log_buffer = NULL;
         return -1;
     }
     
+    // Os processos filhos herdam o log_mutex livre (ver log_prepare_fork)
+    pthread_atfork(log_prepare_fork, log_after_fork, log_after_fork);
+    
     // Inicializar posição
     log_current_pos = 0;
     
@@ -73,7 +98,7 @@ int create_log_file() {
     
     #ifdef DEBUG
     printf("[DEBUG] Ficheiro de log criado e mapeado com sucesso\n");
-    printf("[DEBUG] Nome: %s\n", LOG_FILENAME);
+    printf("[DEBUG] Nome: %s\n", log_path);
     printf("[DEBUG] Tamanho: %d MB\n", LOG_FILE_SIZE / (1024 * 1024));
     printf("[DEBUG] Endereço: %p\n", (void *)log_buffer);
     #endif
@@ -106,7 +131,7 @@ void write_log(const char *format, ...) {
         return;
     }
     
-    pthread_mutex_lock(&log_mutex);
+    lock_mutex(&log_mutex, LOCK_LOG);
     
     char timestamp[32];
     get_timestamp(timestamp, sizeof(timestamp));
@@ -143,7 +168,15 @@ void write_log(const char *format, ...) {
     log_current_pos += line_len;
     
     // Forçar escrita no disco (para garantir persistência)
-    msync(log_buffer, log_current_pos, MS_SYNC);
+    if (timeline_enabled()) {
+        struct timespec flush_start, flush_end;
+        clock_gettime(CLOCK_REALTIME, &flush_start);
+        msync(log_buffer, log_current_pos, MS_SYNC);
+        clock_gettime(CLOCK_REALTIME, &flush_end);
+        timeline_record(TL_LOG_FLUSH, 0, &flush_start, &flush_end);
+    } else {
+        msync(log_buffer, log_current_pos, MS_SYNC);
+    }
     
     // Escrever também no stdout (para visualização em tempo real)
     printf("%s", log_line);
@@ -152,6 +185,20 @@ void write_log(const char *format, ...) {
     pthread_mutex_unlock(&log_mutex);
 }
 
+/*
+ * Migra o mapeamento do log para o nó NUMA indicado
+ * (o log é criado antes de a configuração ser lida)
+ */
+void bind_log_to_numa_node(int node) {
+    if (log_buffer == NULL || node < 0) {
+        return;
+    }
+    
+    if (bind_memory_to_node(log_buffer, LOG_FILE_SIZE, node, 1) != 0) {
+        write_log("AVISO: Não foi possível colocar o log no nó NUMA %d", node);
+    }
+}
+
 /*
  * Fecha e desmapeia o ficheiro de log
  */
@@ -201,5 +248,5 @@ void close_log_file() {
     printf("[DEBUG] Total de bytes escritos: %zu\n", log_current_pos);
     #endif
     
-    printf("\nLog guardado em: %s (%zu bytes)\n", LOG_FILENAME, log_current_pos);
+    printf("\nLog guardado em: %s (%zu bytes)\n", log_path, log_current_pos);
 }
\ No newline at end of file
@@ -22,5 +22,6 @@ extern int log_fd;
 int create_log_file();
 void write_log(const char *format, ...);
 void close_log_file();
+void bind_log_to_numa_node(int node);
 
 #endif // LOG_H
\ No newline at end of file
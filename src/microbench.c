@@ -0,0 +1,117 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/ipc.h>
+#include <sys/msg.h>
+#include "microbench.h"
+#include "msq.h"
+
+FILE *bench_out = NULL;
+
+/* Débito da primeira linha de cada tabela (escala = débito / este) */
+static double baseline_mops = 0.0;
+
+/*
+ * Lê "[ops] [max_workers]" e redireciona o stdout para /dev/null
+ * Retorna 0 em caso de sucesso, -1 se os argumentos forem inválidos
+ */
+int bench_init(int argc, char *argv[], long *ops, int *max_workers) {
+    *ops = MICROBENCH_DEFAULT_OPS;
+    *max_workers = MICROBENCH_DEFAULT_WORKERS;
+    
+    if (argc > 1) {
+        *ops = atol(argv[1]);
+    }
+    if (argc > 2) {
+        *max_workers = atoi(argv[2]);
+    }
+    if (argc > 3 || *ops < 1 || *max_workers < 1 || *max_workers > MICROBENCH_MAX_THREADS) {
+        fprintf(stderr, "Uso: %s [operações (omissão: %d)] [máximo de workers (omissão: %d)]\n",
+                argv[0], MICROBENCH_DEFAULT_OPS, MICROBENCH_DEFAULT_WORKERS);
+        return -1;
+    }
+    
+    int saved = dup(STDOUT_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+    if (saved == -1 || null_fd == -1) {
+        perror("Erro ao redirecionar stdout");
+        return -1;
+    }
+    
+    bench_out = fdopen(saved, "w");
+    if (bench_out == NULL) {
+        perror("Erro ao abrir saída dos resultados");
+        return -1;
+    }
+    setvbuf(bench_out, NULL, _IOLBF, 0);
+    
+    fflush(stdout);
+    dup2(null_fd, STDOUT_FILENO);
+    close(null_fd);
+    
+    return 0;
+}
+
+/*
+ * Indica se já existe uma MSQ do Admission (a SHM e a MSQ têm nomes fixos:
+ * o micro-benchmark iria recriá-las por baixo de um Admission a correr)
+ */
+int bench_ipc_in_use() {
+    key_t key = ftok(MSQ_KEY_PATH, MSQ_KEY_ID);
+    if (key != -1 && msgget(key, 0) != -1) {
+        fprintf(stderr, "ERRO: A MSQ do Admission já existe (Admission a correr? senão: make clean-ipc)\n");
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * Número de workers seguinte: 1, 2, 4, ... e por fim max_workers
+ * Retorna 0 quando já não há mais
+ */
+int bench_next_workers(int workers, int max_workers) {
+    if (workers >= max_workers) {
+        return 0;
+    }
+    return (workers * 2 < max_workers) ? workers * 2 : max_workers;
+}
+
+long long bench_now_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/*
+ * Cabeçalho de uma tabela de resultados
+ */
+void bench_header(const char *title, const char *config_label) {
+    baseline_mops = 0.0;
+    fprintf(bench_out, "\n=== %s ===\n", title);
+    fprintf(bench_out, "%-16s %10s %10s %10s %8s\n", config_label, "ops", "ns/op", "Mops/s", "escala");
+}
+
+/*
+ * Uma linha: ns/op e débito agregados (tempo de parede / operações de
+ * todos os workers) e escala face à primeira linha da tabela
+ */
+void bench_row(const char *config, long ops, long long elapsed_ns) {
+    double ns_per_op = (double)elapsed_ns / ops;
+    double mops = ops * 1e3 / elapsed_ns;
+    
+    if (baseline_mops == 0.0) {
+        baseline_mops = mops;
+    }
+    
+    fprintf(bench_out, "%-16s %10ld %10.1f %10.3f %7.2fx\n", config, ops, ns_per_op, mops,
+            mops / baseline_mops);
+}
@@ -0,0 +1,29 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ */
+
+#ifndef MICROBENCH_H
+#define MICROBENCH_H
+
+#include <stdio.h>
+
+#define MICROBENCH_DEFAULT_OPS 200000   // Operações por configuração
+#define MICROBENCH_DEFAULT_WORKERS 8    // Máximo de threads/processos
+#define MICROBENCH_MAX_THREADS 64       // Limite de workers por lado
+
+/* Resultados (o stdout fica redirecionado para /dev/null durante a medição,
+ * por causa do printf [DEBUG] dos módulos medidos) */
+extern FILE *bench_out;
+
+/* Funções comuns aos micro-benchmarks */
+int bench_init(int argc, char *argv[], long *ops, int *max_workers);
+int bench_ipc_in_use();
+int bench_next_workers(int workers, int max_workers);
+long long bench_now_ns();
+void bench_header(const char *title, const char *config_label);
+void bench_row(const char *config, long ops, long long elapsed_ns);
+
+#endif // MICROBENCH_H
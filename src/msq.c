@@ -5,14 +5,19 @@
  * Aluno : Diogo Marques de Lemos - 2020219666
  */
 
+#define _GNU_SOURCE     // Para MSG_COPY (ler mensagens sem as retirar)
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <time.h>
 #include <sys/types.h>
 #include <sys/ipc.h>
 #include <sys/msg.h>
 #include "msq.h"
+#include "shm.h"
+#include "group.h"
 
 #define DEBUG 
 
@@ -64,9 +69,117 @@ int create_message_queue() {
     return 0;
 }
 
+/*
+ * Anexa à fila de mensagens criada pelo Admission (Doctors e front-ends)
+ * Retorna 0 em caso de sucesso, -1 em caso de erro
+ */
+int attach_message_queue() {
+    key_t key = ftok(MSQ_KEY_PATH, MSQ_KEY_ID);
+    if (key == -1) {
+        return -1;
+    }
+    
+    msq_id = msgget(key, 0666);
+    
+    return (msq_id == -1) ? -1 : 0;
+}
+
+/*
+ * Instante atual (CLOCK_MONOTONIC) em nanossegundos
+ */
+static long long monotonic_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/*
+ * Define a disciplina da fila de atendimento (chamado pelo Admission depois
+ * de criar a memória partilhada, antes de lançar triagem e Doctors)
+ */
+void set_queue_discipline(int discipline, int sjf_max_wait_ms) {
+    if (shm_stats == NULL) {
+        return;
+    }
+    shm_stats->queue_discipline = discipline;
+    shm_stats->sjf_max_wait_ns = (long long)sjf_max_wait_ms * 1000000LL;
+}
+
+/*
+ * Indica se a fila de atendimento está em modo SJF
+ */
+static int sjf_enabled() {
+    return shm_stats != NULL && shm_stats->queue_discipline == QUEUE_DISCIPLINE_SJF;
+}
+
+/*
+ * Índice da fila local (lane) de um grupo para uma prioridade (1-5)
+ * Na MSQ o mtype da lane é lane + 1, por isso o grupo 0 usa os mtypes 1-5
+ */
+static int lane_index(int group, int priority) {
+    return group * NUM_PRIORITIES + (priority - 1);
+}
+
+/*
+ * Conta um paciente que entra numa lane (antes do envio, para que um
+ * Doctor nunca veja os contadores negativos)
+ */
+static void lane_enter(int lane, int priority) {
+    atomic_fetch_add(&shm_stats->queue_depth[priority - 1], 1);
+    atomic_fetch_add(&shm_stats->lane_depth[lane], 1);
+}
+
+/*
+ * Desconta um paciente cujo envio falhou (não chegou a entrar no anel
+ * de instantes de entrada, por isso a saída do anel não avança)
+ */
+static void lane_cancel(int lane, int priority) {
+    atomic_fetch_sub(&shm_stats->queue_depth[priority - 1], 1);
+    atomic_fetch_sub(&shm_stats->lane_depth[lane], 1);
+}
+
+/*
+ * Desconta um paciente que saiu de uma lane
+ */
+static void lane_leave(int lane, int priority) {
+    lane_cancel(lane, priority);
+    atomic_fetch_add(&shm_stats->dequeue_seq[lane], 1);
+}
+
+/*
+ * Modo SJF: insere o paciente no heap da lane na SHM em vez da MSQ
+ * Retorna 0 em caso de sucesso, -1 se a fila estiver cheia
+ */
+static int send_patient_to_sjf_queue(const Patient *patient, int lane) {
+    lane_enter(lane, patient->priority);
+    
+    if (dq_push(&shm_stats->doctor_queue, lane, patient, monotonic_ns()) != 0) {
+        lane_cancel(lane, patient->priority);
+        fprintf(stderr, "ERRO: Fila de atendimento cheia\n");
+        return -1;
+    }
+    
+    return 0;
+}
+
+/*
+ * Modo SJF: retira um paciente do heap de uma lane
+ * Retorna 0 em caso de sucesso, -1 se não houver pacientes
+ */
+static int receive_patient_from_sjf_queue(Patient *patient, int lane) {
+    if (dq_pop(&shm_stats->doctor_queue, lane, shm_stats->sjf_max_wait_ns,
+               monotonic_ns(), patient) != 0) {
+        return -1;
+    }
+    
+    lane_leave(lane, patient->priority);
+    return 0;
+}
+
 /*
  * Envia um paciente para a fila de mensagens
- * A prioridade do paciente determina o tipo da mensagem (mtype)
+ * O paciente vai para a lane (grupo de Doctors) menos carregada que atende
+ * a sua prioridade; o mtype é o da lane
  * Retorna 0 em caso de sucesso, -1 em caso de erro
  */
 int send_patient_to_queue(const Patient *patient) {
@@ -80,17 +193,34 @@ int send_patient_to_queue(const Patient *patient) {
         return -1;
     }
     
+    int lane = -1;
+    if (shm_stats != NULL && patient->priority >= 1 && patient->priority <= NUM_PRIORITIES) {
+        lane = lane_index(route_patient_to_group(patient->priority), patient->priority);
+        
+        if (sjf_enabled()) {
+            return send_patient_to_sjf_queue(patient, lane);
+        }
+    }
+    
     PatientMessage msg;
-    msg.mtype = patient->priority; // Prioridade 1-5
+    msg.mtype = (lane >= 0) ? lane + 1 : patient->priority; // Lane (prioridade 1-5 no grupo 0)
     memcpy(&msg.patient, patient, sizeof(Patient));
     
     #ifdef DEBUG
-    printf("[DEBUG] A enviar paciente %s (prioridade %ld) para fila...\n", 
-           patient->name, msg.mtype);
+    printf("[DEBUG] A enviar paciente %s (prioridade %d, mtype %ld) para fila...\n", 
+           patient->name, patient->priority, msg.mtype);
     #endif
     
+    long long enqueued_ns = monotonic_ns();
+    if (lane >= 0) {
+        lane_enter(lane, patient->priority);
+    }
+    
     // Enviar mensagem (IPC_NOWAIT para não bloquear)
     if (msgsnd(msq_id, &msg, sizeof(Patient), IPC_NOWAIT) == -1) {
+        if (lane >= 0) {
+            lane_cancel(lane, patient->priority);
+        }
         if (errno == EAGAIN) {
             fprintf(stderr, "ERRO: Fila de mensagens cheia\n");
         } else {
@@ -99,6 +229,18 @@ int send_patient_to_queue(const Patient *patient) {
         return -1;
     }
     
+    // Guardar o instante de entrada e o prazo (políticas aging e edf) só
+    // depois do msgsnd: um envio falhado (EAGAIN) não ocupa posição no anel,
+    // e a posição dequeue_seq continua a ser a do mais antigo em fila
+    if (lane >= 0) {
+        unsigned long long seq = atomic_fetch_add(&shm_stats->enqueue_seq[lane], 1);
+        atomic_store_explicit(&shm_stats->enqueue_time_ns[lane][seq % QUEUE_AGE_RING],
+                              enqueued_ns, memory_order_relaxed);
+        atomic_store_explicit(&shm_stats->deadline_ns[lane][seq % QUEUE_AGE_RING],
+                              (long long)patient->deadline.tv_sec * 1000000000LL +
+                              patient->deadline.tv_nsec, memory_order_relaxed);
+    }
+    
     #ifdef DEBUG
     printf("[DEBUG] Paciente %s enviado para fila com sucesso\n", patient->name);
     #endif
@@ -107,58 +249,217 @@ int send_patient_to_queue(const Patient *patient) {
 }
 
 /*
- * Recebe um paciente da fila de mensagens
- * Se priority > 0, recebe apenas mensagens dessa prioridade
- * Se priority = 0, recebe a mensagem com menor mtype (maior prioridade)
- * Se priority < 0, recebe qualquer mensagem com mtype <= |priority| 
+ * Recebe um paciente da lane de um grupo para uma prioridade (1-5)
  * Retorna 0 em caso de sucesso, -1 em caso de erro ou sem mensagens
  */
-int receive_patient_from_queue(Patient *patient, long priority) {
-    if (msq_id == -1) {
-        fprintf(stderr, "ERRO: Fila de mensagens não inicializada\n");
+static int receive_patient_from_lane(Patient *patient, int group, int priority) {
+    int lane = lane_index(group, priority);
+    
+    // Evitar syscalls/locks quando a lane está vazia
+    if (atomic_load(&shm_stats->lane_depth[lane]) <= 0) {
         return -1;
     }
     
-    if (patient == NULL) {
-        fprintf(stderr, "ERRO: Paciente NULL\n");
-        return -1;
+    if (sjf_enabled()) {
+        return receive_patient_from_sjf_queue(patient, lane);
     }
     
     PatientMessage msg;
     
-    // Usar prioridade negativa para obter pacientes por ordem de prioridade
-    // msgtyp = -5 significa: receber mensagem com menor mtype (1,2,3,4,5)
-    // Isto garante que prioridade 1 (mais urgente) é atendida primeiro
-    long msgtyp = (priority == 0) ? -5 : priority;
-    
     // Receber mensagem (IPC_NOWAIT para não bloquear)
-    ssize_t result = msgrcv(msq_id, &msg, sizeof(Patient), msgtyp, IPC_NOWAIT);
+    ssize_t result = msgrcv(msq_id, &msg, sizeof(Patient), lane + 1, IPC_NOWAIT);
     
     if (result == -1) {
-        if (errno == ENOMSG) {
-            // Não há mensagens disponíveis
-            return -1;
-        } else {
+        if (errno != ENOMSG) {
             perror("Erro ao receber paciente da fila (msgrcv)");
-            return -1;
         }
+        return -1;
     }
     
     memcpy(patient, &msg.patient, sizeof(Patient));
+    lane_leave(lane, patient->priority);
     
     #ifdef DEBUG
-    printf("[DEBUG] Paciente %s recebido da fila (prioridade %ld)\n", 
-           patient->name, msg.mtype);
+    printf("[DEBUG] Paciente %s recebido da fila (prioridade %d, grupo %d)\n", 
+           patient->name, patient->priority, group);
     #endif
     
     return 0;
 }
 
+/*
+ * Recebe um paciente das lanes de um grupo de Doctors
+ * Se priority > 0, recebe apenas pacientes dessa prioridade
+ * Se priority = 0, recebe o paciente mais urgente do grupo
+ * Retorna 0 em caso de sucesso, -1 em caso de erro ou sem mensagens
+ */
+int receive_patient_from_queue(Patient *patient, int group, long priority) {
+    if (msq_id == -1) {
+        fprintf(stderr, "ERRO: Fila de mensagens não inicializada\n");
+        return -1;
+    }
+    
+    if (patient == NULL) {
+        fprintf(stderr, "ERRO: Paciente NULL\n");
+        return -1;
+    }
+    
+    if (shm_stats == NULL) {
+        // Sem contadores: ordem estrita do kernel (mtype 1-5 = grupo 0)
+        PatientMessage msg;
+        if (msgrcv(msq_id, &msg, sizeof(Patient), -NUM_PRIORITIES, IPC_NOWAIT) == -1) {
+            return -1;
+        }
+        memcpy(patient, &msg.patient, sizeof(Patient));
+        return 0;
+    }
+    
+    if (priority > 0) {
+        return receive_patient_from_lane(patient, group, (int)priority);
+    }
+    
+    for (int p = 1; p <= NUM_PRIORITIES; p++) {
+        if (receive_patient_from_lane(patient, group, p) == 0) {
+            return 0;
+        }
+    }
+    
+    return -1;
+}
+
+/*
+ * Obtém o número de mensagens de uma prioridade (1-5) na fila (todos os grupos)
+ * Lido dos contadores da memória partilhada, sem syscalls
+ */
+int get_queue_depth(int priority) {
+    if (shm_stats == NULL || priority < 1 || priority > NUM_PRIORITIES) {
+        return 0;
+    }
+    return atomic_load(&shm_stats->queue_depth[priority - 1]);
+}
+
+/*
+ * Obtém o número de mensagens de uma prioridade na lane de um grupo
+ */
+int get_lane_depth(int group, int priority) {
+    if (shm_stats == NULL || group < 0 || group >= MAX_DOCTOR_GROUPS ||
+        priority < 1 || priority > NUM_PRIORITIES) {
+        return 0;
+    }
+    return atomic_load(&shm_stats->lane_depth[lane_index(group, priority)]);
+}
+
+/*
+ * Tempo de espera (ms) do paciente mais antigo de uma lane
+ * A MSQ é FIFO dentro de cada mtype, por isso é o da posição dequeue_seq
+ * Retorna 0 se a lane não tiver pacientes em fila
+ */
+long get_queue_head_age_ms(int group, int priority) {
+    if (get_lane_depth(group, priority) <= 0) {
+        return 0;
+    }
+    
+    int lane = lane_index(group, priority);
+    
+    // No modo SJF a saída não é FIFO: o mais antigo vem do heap de chegada
+    if (sjf_enabled()) {
+        long long oldest = dq_oldest_enqueue_ns(&shm_stats->doctor_queue, lane);
+        return (oldest >= 0) ? (long)((monotonic_ns() - oldest) / 1000000LL) : 0;
+    }
+    
+    // Entre o msgsnd e o registo no anel a posição ainda não foi escrita
+    unsigned long long head = atomic_load(&shm_stats->dequeue_seq[lane]);
+    if (head >= atomic_load(&shm_stats->enqueue_seq[lane])) {
+        return 0;
+    }
+    long long enqueued = atomic_load_explicit(
+        &shm_stats->enqueue_time_ns[lane][head % QUEUE_AGE_RING], memory_order_relaxed);
+    
+    long long age = monotonic_ns() - enqueued;
+    return (age > 0) ? (long)(age / 1000000LL) : 0;
+}
+
+/*
+ * Prazo (SLA, CLOCK_REALTIME em ns) do paciente mais antigo de uma lane,
+ * que é o de prazo mais cedo, porque todos os da lane têm o mesmo alvo
+ * Retorna -1 se a lane não tiver pacientes em fila
+ */
+long long get_queue_head_deadline_ns(int group, int priority) {
+    if (get_lane_depth(group, priority) <= 0) {
+        return -1;
+    }
+    
+    int lane = lane_index(group, priority);
+    
+    if (sjf_enabled()) {
+        return dq_oldest_deadline_ns(&shm_stats->doctor_queue, lane);
+    }
+    
+    unsigned long long head = atomic_load(&shm_stats->dequeue_seq[lane]);
+    if (head >= atomic_load(&shm_stats->enqueue_seq[lane])) {
+        return -1;
+    }
+    return atomic_load_explicit(&shm_stats->deadline_ns[lane][head % QUEUE_AGE_RING],
+                                memory_order_relaxed);
+}
+
+/*
+ * Copia os pacientes da fila de atendimento para 'out' sem os retirar
+ * (checkpoint). Na MSQ usa msgrcv com MSG_COPY, que lê a n-ésima mensagem;
+ * se um Doctor retirar mensagens durante a cópia, algumas podem faltar.
+ * Sem MSG_COPY no kernel (ENOSYS, sem CONFIG_CHECKPOINT_RESTORE) desiste
+ * de vez; cada erro só é reportado uma vez seguida (chamado a cada checkpoint)
+ * Retorna o número de pacientes copiados, ou -1 em caso de erro
+ */
+int snapshot_message_queue(Patient *out, int max) {
+    static int copy_unavailable = 0;
+    static int last_error = 0;
+    
+    if (sjf_enabled()) {
+        return dq_snapshot(&shm_stats->doctor_queue, out, max);
+    }
+    
+    if (msq_id == -1 || copy_unavailable) {
+        return -1;
+    }
+    
+    int count = 0;
+    PatientMessage msg;
+    
+    while (count < max) {
+        if (msgrcv(msq_id, &msg, sizeof(Patient), count, IPC_NOWAIT | MSG_COPY) == -1) {
+            if (errno != ENOMSG) {
+                if (errno != last_error) {
+                    fprintf(stderr, "Erro ao copiar mensagem da fila (msgrcv MSG_COPY): %s\n",
+                            strerror(errno));
+                    last_error = errno;
+                }
+                copy_unavailable = (errno == ENOSYS);
+                return -1;
+            }
+            break;
+        }
+        memcpy(&out[count++], &msg.patient, sizeof(Patient));
+    }
+    
+    last_error = 0;
+    return count;
+}
+
 /*
  * Obtém o número de mensagens na fila
+ * Usa os contadores da memória partilhada; só recorre a msgctl sem SHM
  * Retorna o número de mensagens, ou -1 em caso de erro
  */
 int get_queue_size() {
+    if (shm_stats != NULL) {
+        int total = 0;
+        for (int p = 1; p <= NUM_PRIORITIES; p++) {
+            total += get_queue_depth(p);
+        }
+        return total;
+    }
+    
     if (msq_id == -1) {
         fprintf(stderr, "ERRO: Fila de mensagens não inicializada\n");
         return -1;
@@ -16,6 +16,10 @@
 #define MSQ_KEY_PATH "/tmp"
 #define MSQ_KEY_ID 'U'  
 
+/* Disciplina dentro de cada prioridade (QUEUE_DISCIPLINE em config.txt) */
+#define QUEUE_DISCIPLINE_FIFO 0     // MSQ: ordem de chegada
+#define QUEUE_DISCIPLINE_SJF  1     // Heap na SHM: menor attendance_time primeiro
+
 /* Estrutura da mensagem para a fila */
 typedef struct {
     long mtype;              // Tipo da mensagem (prioridade: 1-5)
@@ -27,9 +31,16 @@ extern int msq_id;
 
 /* Funções para gestão da fila de mensagens */
 int create_message_queue();
+int attach_message_queue();
 int send_patient_to_queue(const Patient *patient);
-int receive_patient_from_queue(Patient *patient, long priority);
+int receive_patient_from_queue(Patient *patient, int group, long priority);
 int get_queue_size();
+int get_lane_depth(int group, int priority);
+void set_queue_discipline(int discipline, int sjf_max_wait_ms);
+int get_queue_depth(int priority);
+long get_queue_head_age_ms(int group, int priority);
+long long get_queue_head_deadline_ns(int group, int priority);
+int snapshot_message_queue(Patient *out, int max);
 void destroy_message_queue();
 
 #endif // MSQ_H
\ No newline at end of file
@@ -9,8 +9,15 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <stdatomic.h>
 #include "patient.h"
 
+/* Cabeçalho de um bloco: o bloco é libertado quando o último paciente sai */
+struct PatientBlock {
+    atomic_int refcount;          // Pacientes do bloco ainda vivos
+    Patient patients[];           // Pacientes (contíguos em memória)
+};
+
 /*
  * Cria e inicializa um novo paciente
  */
@@ -28,6 +35,7 @@ Patient* create_patient(int arrival_number, const char *name,
     patient->triage_time = triage_time;
     patient->attendance_time = attendance_time;
     patient->priority = priority;
+    patient->block = NULL;
     
     // Registar hora de chegada
     clock_gettime(CLOCK_REALTIME, &patient->arrival_time);
@@ -37,17 +45,126 @@ Patient* create_patient(int arrival_number, const char *name,
     memset(&patient->triage_end, 0, sizeof(struct timespec));
     memset(&patient->attendance_start, 0, sizeof(struct timespec));
     memset(&patient->attendance_end, 0, sizeof(struct timespec));
+    memset(&patient->deadline, 0, sizeof(struct timespec));
+    patient->triage_thread = 0;
+    patient->triage_queue_depth = 0;
+    patient->queue_depth = 0;
     
     return patient;
 }
 
+/*
+ * Marca o limite para início do atendimento: chegada + target_ms
+ * (alvo SLA_TARGET_MS da prioridade, aplicado no fim da triagem)
+ */
+void set_patient_deadline(Patient *patient, int target_ms) {
+    patient->deadline.tv_sec = patient->arrival_time.tv_sec + target_ms / 1000;
+    patient->deadline.tv_nsec = patient->arrival_time.tv_nsec + (long)(target_ms % 1000) * 1000000L;
+    if (patient->deadline.tv_nsec >= 1000000000L) {
+        patient->deadline.tv_sec++;
+        patient->deadline.tv_nsec -= 1000000000L;
+    }
+}
+
+/*
+ * Escreve o prefixo dos nomes automáticos ("AAAAMMDD-")
+ * Calculado uma vez por grupo em vez de uma vez por paciente
+ */
+void format_name_prefix(char *prefix, size_t size) {
+    time_t now = time(NULL);
+    struct tm tm_info;
+    localtime_r(&now, &tm_info);
+    snprintf(prefix, size, "%04d%02d%02d-",
+             tm_info.tm_year + 1900, tm_info.tm_mon + 1, tm_info.tm_mday);
+}
+
+/*
+ * Escreve 'prefix' seguido de 'number' (mínimo 3 dígitos) em 'name'
+ * Equivalente a snprintf("%s%03d") sem o custo de interpretar o formato
+ */
+static void build_patient_name(char *name, const char *prefix, size_t prefix_len, int number) {
+    char digits[12];
+    int n = 0;
+    unsigned int value = (unsigned int)number;
+    
+    do {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    
+    while (n < 3) {
+        digits[n++] = '0';
+    }
+    
+    memcpy(name, prefix, prefix_len);
+    size_t pos = prefix_len;
+    while (n > 0 && pos < MAX_NAME_LENGTH - 1) {
+        name[pos++] = digits[--n];
+    }
+    name[pos] = '\0';
+}
+
+/*
+ * Cria 'count' pacientes numa única alocação (grupos de pacientes)
+ * Os números de chegada são consecutivos a partir de 'first_arrival_number'
+ * e os nomes são '<name_prefix><número>'. Cada paciente continua a ser
+ * libertado individualmente com free_patient().
+ * Retorna o array de pacientes, ou NULL em caso de erro
+ */
+Patient* create_patient_batch(int count, int first_arrival_number, const char *name_prefix,
+                              int triage_time, int attendance_time, int priority) {
+    if (count <= 0) {
+        return NULL;
+    }
+    
+    PatientBlock *block = malloc(sizeof(PatientBlock) + (size_t)count * sizeof(Patient));
+    if (block == NULL) {
+        perror("Erro ao alocar memória para grupo de pacientes");
+        return NULL;
+    }
+    
+    atomic_init(&block->refcount, count);
+    
+    // Todos os pacientes do grupo chegam no mesmo instante
+    struct timespec arrival;
+    clock_gettime(CLOCK_REALTIME, &arrival);
+    
+    size_t prefix_len = strnlen(name_prefix, MAX_NAME_LENGTH - 4);
+    
+    for (int i = 0; i < count; i++) {
+        Patient *patient = &block->patients[i];
+        
+        memset(patient, 0, sizeof(Patient));
+        patient->arrival_number = first_arrival_number + i;
+        build_patient_name(patient->name, name_prefix, prefix_len, patient->arrival_number);
+        patient->triage_time = triage_time;
+        patient->attendance_time = attendance_time;
+        patient->priority = priority;
+        patient->arrival_time = arrival;
+        patient->block = block;
+    }
+    
+    return block->patients;
+}
+
 /*
  * Liberta a memória de um paciente
  */
 void free_patient(Patient *patient) {
-    if (patient != NULL) {
-        free(patient);
+    if (patient == NULL) {
+        return;
     }
+    
+    if (patient->block != NULL) {
+        // Último paciente do bloco liberta o bloco inteiro
+        PatientBlock *block = patient->block;
+        if (atomic_fetch_sub(&block->refcount, 1) == 1) {
+            free(block);
+        }
+        return;
+    }
+    
+    free(patient);
 }
 
 /*
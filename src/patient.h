@@ -8,9 +8,14 @@
 #ifndef PATIENT_H
 #define PATIENT_H
 
+#include <stddef.h>
 #include <time.h>
 
 #define MAX_NAME_LENGTH 64
+#define NUM_PRIORITIES 5   // Prioridades 1 (mais urgente) a 5
+
+/* Bloco de pacientes alocados de uma só vez (ver create_patient_batch) */
+typedef struct PatientBlock PatientBlock;
 
 /* Estrutura para representar um paciente */
 typedef struct {
@@ -26,11 +31,23 @@ typedef struct {
     struct timespec triage_end;        // Fim da triagem
     struct timespec attendance_start;  // Início do atendimento
     struct timespec attendance_end;    // Fim do atendimento
+    struct timespec deadline;          // Limite para início do atendimento (SLA)
+    
+    // Rasto por paciente (PATIENT_TRACE_MAX): quem triou e filas encontradas
+    int triage_thread;            // Thread de triagem (0 = ainda não triado)
+    int triage_queue_depth;       // Pacientes na fila de triagem à chegada
+    int queue_depth;              // Pacientes na fila de atendimento ao entrar
+    
+    PatientBlock *block;          // Bloco de origem (NULL = alocação individual)
 } Patient;
 
 /* Funções para gestão de pacientes */
 Patient* create_patient(int arrival_number, const char *name, 
                        int triage_time, int attendance_time, int priority);
+Patient* create_patient_batch(int count, int first_arrival_number, const char *name_prefix,
+                              int triage_time, int attendance_time, int priority);
+void format_name_prefix(char *prefix, size_t size);
+void set_patient_deadline(Patient *patient, int target_ms);
 void free_patient(Patient *patient);
 void print_patient(const Patient *patient);
 
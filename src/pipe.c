@@ -13,23 +13,28 @@
 #include <fcntl.h>
 #include <errno.h>
 #include "pipe.h"
+#include "scaleout.h"
 
 #define DEBUG 
 
+/* Descritores de escrita mantidos abertos pelo próprio leitor */
+static int pipe_keepalive_fd = -1;
+static int batch_keepalive_fd = -1;
+
 /*
- * Cria o named pipe
+ * Cria um FIFO no caminho indicado (remove o anterior, se existir)
  * Retorna 0 em caso de sucesso, -1 em caso de erro
  */
-int create_named_pipe() {
+static int create_fifo(const char *path) {
     #ifdef DEBUG
-    printf("[DEBUG] A criar named pipe '%s'...\n", PIPE_NAME);
+    printf("[DEBUG] A criar named pipe '%s'...\n", path);
     #endif
     
     // Remover named pipe anterior (se existir)
-    unlink(PIPE_NAME);
+    unlink(path);
     
     // Criar o named pipe com permissões 0666
-    if (mkfifo(PIPE_NAME, 0666) == -1) {
+    if (mkfifo(path, 0666) == -1) {
         if (errno != EEXIST) {
             perror("Erro ao criar named pipe (mkfifo)");
             return -1;
@@ -40,31 +45,39 @@ int create_named_pipe() {
     }
     
     #ifdef DEBUG
-    printf("[DEBUG] Named pipe '%s' criado com sucesso\n", PIPE_NAME);
+    printf("[DEBUG] Named pipe '%s' criado com sucesso\n", path);
     #endif
     
-    printf("Named pipe criado: %s\n", PIPE_NAME);
+    printf("Named pipe criado: %s\n", path);
     
     return 0;
 }
 
 /*
- * Abre o named pipe para leitura (não-bloqueante)
- * Retorna o file descriptor, ou -1 em caso de erro
+ * Abre um FIFO para leitura (não-bloqueante)
+ * Abre também uma ponta de escrita que nunca é usada: assim o FIFO nunca
+ * fica sem escritores e o select() não devolve EOF em ciclo quando os
+ * produtores fecham a ligação
+ * Retorna o file descriptor de leitura, ou -1 em caso de erro
  */
-int open_named_pipe_read() {
+static int open_fifo_read(const char *path, int *keepalive_fd) {
     #ifdef DEBUG
-    printf("[DEBUG] A abrir named pipe para leitura...\n");
+    printf("[DEBUG] A abrir named pipe '%s' para leitura...\n", path);
     #endif
     
     // Abrir em modo não-bloqueante para não ficar preso se não houver escritores
-    int fd = open(PIPE_NAME, O_RDONLY | O_NONBLOCK);
+    int fd = open(path, O_RDONLY | O_NONBLOCK);
     
     if (fd == -1) {
         perror("Erro ao abrir named pipe para leitura");
         return -1;
     }
     
+    *keepalive_fd = open(path, O_WRONLY | O_NONBLOCK);
+    if (*keepalive_fd == -1) {
+        perror("Aviso: Erro ao abrir ponta de escrita do named pipe");
+    }
+    
     #ifdef DEBUG
     printf("[DEBUG] Named pipe aberto (fd: %d)\n", fd);
     #endif
@@ -72,6 +85,56 @@ int open_named_pipe_read() {
     return fd;
 }
 
+/*
+ * Remove um FIFO e fecha a respetiva ponta de escrita
+ */
+static void destroy_fifo(const char *path, int *keepalive_fd) {
+    #ifdef DEBUG
+    printf("[DEBUG] A destruir named pipe '%s'...\n", path);
+    #endif
+    
+    if (*keepalive_fd != -1) {
+        close(*keepalive_fd);
+        *keepalive_fd = -1;
+    }
+    
+    if (unlink(path) == -1) {
+        if (errno != ENOENT) {
+            perror("Aviso: Erro ao remover named pipe");
+        }
+    } else {
+        #ifdef DEBUG
+        printf("[DEBUG] Named pipe destruído com sucesso\n");
+        #endif
+    }
+}
+
+/*
+ * Nome do FIFO desta instância ("base.N" nos front-ends, ver scaleout.c)
+ */
+static const char* fifo_name(const char *base, char *name) {
+    instance_name(base, name, INSTANCE_NAME_MAX);
+    return name;
+}
+
+/*
+ * Cria o named pipe
+ * Retorna 0 em caso de sucesso, -1 em caso de erro
+ */
+int create_named_pipe() {
+    char name[INSTANCE_NAME_MAX];
+    return create_fifo(fifo_name(PIPE_NAME, name));
+}
+
+/*
+ * Abre o named pipe para leitura (não-bloqueante)
+ * Retorna o file descriptor, ou -1 em caso de erro
+ */
+int open_named_pipe_read() {
+    char name[INSTANCE_NAME_MAX];
+    return open_fifo_read(fifo_name(PIPE_NAME, name), &pipe_keepalive_fd);
+}
+
 /*
  * Fecha o named pipe
  */
@@ -88,17 +151,32 @@ void close_named_pipe(int fd) {
  * Destrói o named pipe
  */
 void destroy_named_pipe() {
-    #ifdef DEBUG
-    printf("[DEBUG] A destruir named pipe '%s'...\n", PIPE_NAME);
-    #endif
-    
-    if (unlink(PIPE_NAME) == -1) {
-        if (errno != ENOENT) {
-            perror("Aviso: Erro ao remover named pipe");
-        }
-    } else {
-        #ifdef DEBUG
-        printf("[DEBUG] Named pipe destruído com sucesso\n");
-        #endif
-    }
+    char name[INSTANCE_NAME_MAX];
+    destroy_fifo(fifo_name(PIPE_NAME, name), &pipe_keepalive_fd);
+}
+
+/*
+ * Cria o named pipe do protocolo binário
+ * Retorna 0 em caso de sucesso, -1 em caso de erro
+ */
+int create_batch_pipe() {
+    char name[INSTANCE_NAME_MAX];
+    return create_fifo(fifo_name(BATCH_PIPE_NAME, name));
+}
+
+/*
+ * Abre o named pipe binário para leitura (não-bloqueante)
+ * Retorna o file descriptor, ou -1 em caso de erro
+ */
+int open_batch_pipe_read() {
+    char name[INSTANCE_NAME_MAX];
+    return open_fifo_read(fifo_name(BATCH_PIPE_NAME, name), &batch_keepalive_fd);
+}
+
+/*
+ * Destrói o named pipe binário
+ */
+void destroy_batch_pipe() {
+    char name[INSTANCE_NAME_MAX];
+    destroy_fifo(fifo_name(BATCH_PIPE_NAME, name), &batch_keepalive_fd);
 }
\ No newline at end of file
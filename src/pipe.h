@@ -8,13 +8,45 @@
 #ifndef PIPE_H
 #define PIPE_H
 
+#include <stdint.h>
+
 #define PIPE_NAME "/tmp/input_pipe"
 #define PIPE_BUFFER_SIZE 256
 
+/* Named pipe para o protocolo binário de ingestão em lote */
+#define BATCH_PIPE_NAME "/tmp/input_pipe_bin"
+#define BATCH_READ_SIZE 65536
+
+/*
+ * Protocolo binário: cada frame é um BatchHeader seguido de 'count'
+ * BatchRecord (estruturas packed, little-endian da máquina)
+ */
+#define BATCH_MAGIC 0x49454455u        // "UDEI" em little-endian
+#define BATCH_MAX_RECORDS 1000000      // Limite de registos por frame
+#define BATCH_NAME_LENGTH 32           // Nome vazio = nome gerado automaticamente
+#define BATCH_ADMIT_CHUNK 1024         // Pacientes admitidos por aquisição do mutex
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;                    // BATCH_MAGIC
+    uint32_t count;                    // Número de registos no frame
+} BatchHeader;
+
+typedef struct __attribute__((packed)) {
+    char name[BATCH_NAME_LENGTH];      // Nome do paciente (não precisa de '\0')
+    int32_t triage_time;               // Tempo de triagem (ms)
+    int32_t attendance_time;           // Tempo de atendimento (ms)
+    int32_t priority;                  // Prioridade (1-5)
+} BatchRecord;
+
 /* Funções para gestão do named pipe */
 int create_named_pipe();
 int open_named_pipe_read();
 void close_named_pipe(int fd);
 void destroy_named_pipe();
 
-#endif // PIPE_H
\ No newline at end of file
+/* Funções para gestão do named pipe binário */
+int create_batch_pipe();
+int open_batch_pipe_read();
+void destroy_batch_pipe();
+
+#endif // PIPE_H
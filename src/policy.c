@@ -0,0 +1,202 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "policy.h"
+#include "shm.h"
+#include "msq.h"
+
+/*
+ * Converte o nome da política ("strict", "aging", "wfq", "edf") no seu código
+ * Retorna o código, ou -1 se o nome for desconhecido
+ */
+int parse_sched_policy(const char *name) {
+    if (strcmp(name, "strict") == 0) {
+        return SCHED_POLICY_STRICT;
+    }
+    if (strcmp(name, "aging") == 0) {
+        return SCHED_POLICY_AGING;
+    }
+    if (strcmp(name, "wfq") == 0) {
+        return SCHED_POLICY_WFQ;
+    }
+    if (strcmp(name, "edf") == 0) {
+        return SCHED_POLICY_EDF;
+    }
+    return -1;
+}
+
+/*
+ * Nome de uma política (para o print_config e o log)
+ */
+const char* sched_policy_name(int policy) {
+    switch (policy) {
+        case SCHED_POLICY_AGING: return "aging";
+        case SCHED_POLICY_WFQ:   return "wfq";
+        case SCHED_POLICY_EDF:   return "edf";
+        default:                 return "strict";
+    }
+}
+
+/*
+ * Lê uma lista de NUM_PRIORITIES inteiros não negativos ("16,8,4,2,1")
+ * Retorna 0 em caso de sucesso, -1 se a lista for inválida
+ */
+int parse_priority_list(const char *spec, int values[NUM_PRIORITIES]) {
+    const char *p = spec;
+    
+    for (int i = 0; i < NUM_PRIORITIES; i++) {
+        char *end;
+        long value = strtol(p, &end, 10);
+        
+        if (end == p || value < 0 || value > 1000000) {
+            return -1;
+        }
+        values[i] = (int)value;
+        
+        if (i < NUM_PRIORITIES - 1) {
+            if (*end != ',') {
+                return -1;
+            }
+            p = end + 1;
+        } else if (*end != '\0') {
+            return -1;
+        }
+    }
+    
+    return 0;
+}
+
+/*
+ * Aging: a prioridade efetiva de cada lane do grupo com pacientes em fila é
+ * a nominal menos um nível por cada SCHED_AGING_MS[p] que o paciente mais
+ * antigo já esperou. Ganha a menor; em empate, a mais urgente.
+ */
+static long select_aging(const Config *config, int group) {
+    int best = 0;
+    double best_effective = 0.0;
+    
+    for (int p = 1; p <= NUM_PRIORITIES; p++) {
+        if (get_lane_depth(group, p) <= 0) {
+            continue;
+        }
+        
+        double effective = p;
+        int step_ms = config->sched_aging_ms[p - 1];
+        if (step_ms > 0) {
+            effective -= (double)get_queue_head_age_ms(group, p) / step_ms;
+        }
+        
+        if (best == 0 || effective < best_effective) {
+            best = p;
+            best_effective = effective;
+        }
+    }
+    
+    return best;
+}
+
+/*
+ * WFQ (stride scheduling): cada lane avança wfq_pass em
+ * WFQ_STRIDE_BASE / peso por paciente atendido e é escolhida a de menor
+ * passo. Uma lane que esteve vazia retoma a partir do wfq_vtime do grupo,
+ * para não acumular crédito enquanto não tinha pacientes.
+ */
+static long select_wfq(int group) {
+    int best = 0;
+    long long best_pass = 0;
+    long long vtime = atomic_load(&shm_stats->wfq_vtime[group]);
+    
+    for (int p = 1; p <= NUM_PRIORITIES; p++) {
+        if (get_lane_depth(group, p) <= 0) {
+            continue;
+        }
+        
+        long long pass = atomic_load(&shm_stats->wfq_pass[group * NUM_PRIORITIES + p - 1]);
+        if (pass < vtime) {
+            pass = vtime;
+        }
+        
+        if (best == 0 || pass < best_pass) {
+            best = p;
+            best_pass = pass;
+        }
+    }
+    
+    return best;
+}
+
+/*
+ * EDF: escolhe a lane do grupo cujo paciente mais antigo tem o prazo mais
+ * cedo, ou seja, o mais atrasado em relação ao seu SLA. Em empate ganha a
+ * prioridade mais urgente.
+ */
+static long select_edf(int group) {
+    int best = 0;
+    long long best_deadline = 0;
+    
+    for (int p = 1; p <= NUM_PRIORITIES; p++) {
+        long long deadline = get_queue_head_deadline_ns(group, p);
+        if (deadline < 0) {
+            continue;
+        }
+        
+        if (best == 0 || deadline < best_deadline) {
+            best = p;
+            best_deadline = deadline;
+        }
+    }
+    
+    return best;
+}
+
+/*
+ * Escolhe a prioridade que o Doctor deve tentar receber a seguir nas lanes
+ * do grupo 'group'
+ * Retorna 1-5, ou 0 para usar a ordem estrita
+ */
+long select_next_priority(const Config *config, int group) {
+    if (shm_stats == NULL) {
+        return 0;
+    }
+    
+    switch (config->sched_policy) {
+        case SCHED_POLICY_AGING: return select_aging(config, group);
+        case SCHED_POLICY_WFQ:   return select_wfq(group);
+        case SCHED_POLICY_EDF:   return select_edf(group);
+        default:                 return 0;
+    }
+}
+
+/*
+ * Atualiza o estado da política depois de um Doctor receber um paciente
+ */
+void policy_patient_dequeued(const Config *config, int group, int priority) {
+    if (config->sched_policy != SCHED_POLICY_WFQ || shm_stats == NULL ||
+        priority < 1 || priority > NUM_PRIORITIES) {
+        return;
+    }
+    
+    int weight = config->sched_weights[priority - 1];
+    if (weight <= 0) {
+        weight = 1;
+    }
+    
+    // Corridas entre Doctors só desviam ligeiramente a partilha (sem locks)
+    int lane = group * NUM_PRIORITIES + priority - 1;
+    long long vtime = atomic_load(&shm_stats->wfq_vtime[group]);
+    long long pass = atomic_load(&shm_stats->wfq_pass[lane]);
+    if (pass < vtime) {
+        pass = vtime;
+    }
+    
+    atomic_store(&shm_stats->wfq_vtime[group], pass);
+    atomic_store(&shm_stats->wfq_pass[lane], pass + WFQ_STRIDE_BASE / weight);
+}
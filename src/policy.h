@@ -0,0 +1,31 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ */
+
+#ifndef POLICY_H
+#define POLICY_H
+
+#include "config.h"
+#include "patient.h"
+
+/* Políticas de escalonamento dos Doctors (SCHED_POLICY em config.txt) */
+#define SCHED_POLICY_STRICT 0   // Prioridade estrita (msgrcv com -5)
+#define SCHED_POLICY_AGING  1   // Prioridade efetiva melhora com o tempo em fila
+#define SCHED_POLICY_WFQ    2   // Partilha ponderada entre prioridades
+#define SCHED_POLICY_EDF    3   // Prazo (SLA_TARGET_MS) mais cedo primeiro
+
+#define WFQ_STRIDE_BASE 1048576LL   // Passo de uma prioridade = base / peso
+
+/* Funções para configuração da política */
+int parse_sched_policy(const char *name);
+const char* sched_policy_name(int policy);
+int parse_priority_list(const char *spec, int values[NUM_PRIORITIES]);
+
+/* Funções usadas pelos Doctors */
+long select_next_priority(const Config *config, int group);
+void policy_patient_dequeued(const Config *config, int group, int priority);
+
+#endif // POLICY_H
@@ -0,0 +1,349 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <unistd.h>
+#include <stdatomic.h>
+#include <sys/inotify.h>
+#include "reload.h"
+#include "shm.h"
+#include "log.h"
+#include "lockstat.h"
+#include "doctor.h"
+#include "triage.h"
+#include "group.h"
+#include "msq.h"
+#include "policy.h"
+#include "checkpoint.h"
+#include "scaleout.h"
+
+#define DEBUG
+
+/* Nome do ficheiro observado (relativo ao diretório atual) */
+static char watched_name[CONFIG_STRING_SIZE];
+
+/* Parâmetro inteiro de Config, para comparar configurações */
+typedef struct {
+    const char *name;
+    size_t offset;
+} ConfigField;
+
+/* Aplicados a quente */
+static const ConfigField live_fields[] = {
+    {"TRIAGE", offsetof(Config, triage)},
+    {"DOCTORS", offsetof(Config, doctors)},
+    {"SHIFT_LENGTH", offsetof(Config, shift_length)},
+    {"MSQ_WAIT_MAX", offsetof(Config, msq_wait_max)},
+    {"TRIAGE_AUTOSCALE", offsetof(Config, triage_autoscale)},
+    {"TRIAGE_MIN", offsetof(Config, triage_min)},
+    {"TRIAGE_MAX", offsetof(Config, triage_max)},
+    {"WARM_DOCTORS", offsetof(Config, warm_doctors)},
+    {"TEMP_DOCTORS_MAX", offsetof(Config, temp_doctors_max)},
+    {"SJF_MAX_WAIT_MS", offsetof(Config, sjf_max_wait_ms)},
+    {"DRAIN_TIMEOUT_MS", offsetof(Config, drain_timeout_ms)},
+    {"CHECKPOINT_INTERVAL_MS", offsetof(Config, checkpoint_interval_ms)}
+};
+
+/* Dimensionam estruturas já criadas: só mudam ao reiniciar */
+static const ConfigField restart_fields[] = {
+    {"TRIAGE_QUEUE_MAX", offsetof(Config, triage_queue_max)},
+    {"QUEUE_DISCIPLINE", offsetof(Config, queue_discipline)},
+    {"PATIENT_TRACE_MAX", offsetof(Config, patient_trace_max)},
+    {"TIMELINE_MAX_EVENTS", offsetof(Config, timeline_max_events)}
+};
+
+#define NUM_FIELDS(fields) ((int)(sizeof(fields) / sizeof(fields[0])))
+
+static int* field_of(Config *config, const ConfigField *field) {
+    return (int *)((char *)config + field->offset);
+}
+
+/*
+ * Observa o diretório atual à procura de escritas em 'filename' (os
+ * editores costumam gravar um ficheiro novo e renomeá-lo, por isso não
+ * basta observar o próprio ficheiro)
+ * Retorna o descritor a incluir no select, ou -1 em caso de erro
+ */
+int open_config_watch(const char *filename) {
+    int watch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watch_fd == -1) {
+        perror("Erro ao criar inotify");
+        return -1;
+    }
+    
+    if (inotify_add_watch(watch_fd, ".", IN_CLOSE_WRITE | IN_MOVED_TO) == -1) {
+        perror("Erro ao observar o diretório da configuração");
+        close(watch_fd);
+        return -1;
+    }
+    
+    snprintf(watched_name, sizeof(watched_name), "%s", filename);
+    
+    #ifdef DEBUG
+    printf("[DEBUG] A observar %s (inotify fd %d)\n", filename, watch_fd);
+    #endif
+    
+    return watch_fd;
+}
+
+/*
+ * Consome os eventos pendentes
+ * Retorna 1 se algum disser respeito ao ficheiro observado, 0 caso contrário
+ */
+int config_watch_changed(int watch_fd) {
+    _Alignas(struct inotify_event) char buffer[4096];
+    int changed = 0;
+    ssize_t length;
+    
+    while ((length = read(watch_fd, buffer, sizeof(buffer))) > 0) {
+        char *p = buffer;
+        while (p < buffer + length) {
+            const struct inotify_event *event = (const struct inotify_event *)p;
+            if (event->len > 0 && strcmp(event->name, watched_name) == 0) {
+                changed = 1;
+            }
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+    
+    return changed;
+}
+
+void close_config_watch(int watch_fd) {
+    if (watch_fd >= 0) {
+        close(watch_fd);
+    }
+}
+
+/*
+ * Repõe em 'next' os parâmetros que não podem mudar a quente, avisando
+ * quando o ficheiro os altera
+ */
+static void keep_restart_only(Config *current, Config *next) {
+    for (int i = 0; i < NUM_FIELDS(restart_fields); i++) {
+        int *old_value = field_of(current, &restart_fields[i]);
+        int *new_value = field_of(next, &restart_fields[i]);
+        if (*new_value != *old_value) {
+            write_log("AVISO: %s só muda ao reiniciar (mantido %d)", restart_fields[i].name, *old_value);
+            *new_value = *old_value;
+        }
+    }
+    
+    if (strcmp(next->triage_cpus, current->triage_cpus) != 0) {
+        write_log("AVISO: TRIAGE_CPUS só muda ao reiniciar (mantido \"%s\")", current->triage_cpus);
+        memcpy(next->triage_cpus, current->triage_cpus, sizeof(next->triage_cpus));
+    }
+    
+    // As lanes da fila de atendimento seguem as prioridades de cada grupo;
+    // a quente só pode mudar o número de Doctors de cada um
+    int same_groups = (next->num_groups == current->num_groups);
+    for (int g = 0; same_groups && g < current->num_groups; g++) {
+        same_groups = next->group_low[g] == current->group_low[g] &&
+                      next->group_high[g] == current->group_high[g];
+    }
+    
+    if (!same_groups) {
+        write_log("AVISO: As prioridades de DOCTOR_GROUPS só mudam ao reiniciar "
+                  "(mantidos os grupos e DOCTORS = %d)", current->doctors);
+        next->doctors = current->doctors;
+        next->num_groups = current->num_groups;
+        memcpy(next->group_low, current->group_low, sizeof(next->group_low));
+        memcpy(next->group_high, current->group_high, sizeof(next->group_high));
+        memcpy(next->group_doctors, current->group_doctors, sizeof(next->group_doctors));
+    }
+}
+
+/*
+ * Regista uma lista alterada ("nome: a,b,... -> c,d,...")
+ * Retorna 1 se a lista mudou, 0 caso contrário
+ */
+static int log_list_change(const char *name, const int *old_values, const int *new_values, int count) {
+    if (memcmp(old_values, new_values, count * sizeof(int)) == 0) {
+        return 0;
+    }
+    
+    char old_text[CONFIG_STRING_SIZE], new_text[CONFIG_STRING_SIZE];
+    int old_used = 0, new_used = 0;
+    for (int i = 0; i < count; i++) {
+        old_used += snprintf(old_text + old_used, sizeof(old_text) - old_used, "%s%d",
+                             (i > 0) ? "," : "", old_values[i]);
+        new_used += snprintf(new_text + new_used, sizeof(new_text) - new_used, "%s%d",
+                             (i > 0) ? "," : "", new_values[i]);
+    }
+    
+    write_log("%s: %s -> %s", name, old_text, new_text);
+    return 1;
+}
+
+/*
+ * Regista no log cada parâmetro alterado
+ * Retorna o número de alterações
+ */
+static int log_changes(Config *current, Config *next) {
+    int changes = 0;
+    
+    for (int i = 0; i < NUM_FIELDS(live_fields); i++) {
+        int old_value = *field_of(current, &live_fields[i]);
+        int new_value = *field_of(next, &live_fields[i]);
+        if (new_value != old_value) {
+            write_log("%s: %d -> %d", live_fields[i].name, old_value, new_value);
+            changes++;
+        }
+    }
+    
+    if (next->sched_policy != current->sched_policy) {
+        write_log("SCHED_POLICY: %s -> %s", sched_policy_name(current->sched_policy),
+                  sched_policy_name(next->sched_policy));
+        changes++;
+    }
+    
+    changes += log_list_change("SCHED_WEIGHTS", current->sched_weights, next->sched_weights, NUM_PRIORITIES);
+    changes += log_list_change("SCHED_AGING_MS", current->sched_aging_ms, next->sched_aging_ms, NUM_PRIORITIES);
+    changes += log_list_change("SLA_TARGET_MS", current->sla_target_ms, next->sla_target_ms, NUM_PRIORITIES);
+    if (current->num_groups > 1) {
+        changes += log_list_change("Doctors por grupo", current->group_doctors, next->group_doctors,
+                                   current->num_groups);
+    }
+    
+    if (strcmp(next->doctor_cpus, current->doctor_cpus) != 0) {
+        write_log("DOCTOR_CPUS: \"%s\" -> \"%s\" (Doctors lançados a partir de agora)",
+                  current->doctor_cpus, next->doctor_cpus);
+        changes++;
+    }
+    
+    return changes;
+}
+
+/*
+ * Aplica as alterações de 'old' para 'config' (já atualizada)
+ * SHIFT_LENGTH, MSQ_WAIT_MAX, TEMP_DOCTORS_MAX, WARM_DOCTORS e
+ * DRAIN_TIMEOUT_MS são lidos de 'config' a cada utilização (na thread
+ * principal); SLA_TARGET_MS é copiado para a triagem e a política
+ * dos Doctors chega-lhes pelo bloco publicado na memória partilhada
+ * Num front-end (modo scale-out) só a triagem muda: Doctors, fila de
+ * atendimento e checkpoint são do coordenador
+ */
+static void apply_changes(const Config *old, Config *config) {
+    if (frontend_id == 0) {
+        // Doctors por grupo antes da pool, para a carga por grupo ficar certa
+        if (memcmp(old->group_doctors, config->group_doctors, sizeof(config->group_doctors)) != 0) {
+            publish_doctor_groups(config);
+        }
+        
+        // Os Doctors novos já arrancam com a configuração nova (fork)
+        if (config->doctors != old->doctors && resize_doctor_pool(config) != 0) {
+            write_log("AVISO: Falha ao ajustar a pool para %d Doctors", config->doctors);
+        }
+    }
+    
+    if (memcmp(old->sla_target_ms, config->sla_target_ms, sizeof(config->sla_target_ms)) != 0) {
+        update_triage_sla(config);
+    }
+    
+    // Com autoscaling é o autoscaler que decide o número de threads
+    int autoscale_changed = config->triage_autoscale != old->triage_autoscale ||
+                            config->triage_min != old->triage_min ||
+                            config->triage_max != old->triage_max;
+    if (autoscale_changed) {
+        stop_triage_autoscaler();
+        if (config->triage_autoscale && start_triage_autoscaler(config) != 0) {
+            write_log("AVISO: Falha ao reiniciar autoscaler da triagem");
+        }
+    }
+    
+    if (!config->triage_autoscale && (config->triage != old->triage || old->triage_autoscale) &&
+        change_triage_threads(config->triage, config) != 0) {
+        write_log("AVISO: Falha ao alterar threads de triagem para %d", config->triage);
+    }
+    
+    if (frontend_id > 0) {
+        return;
+    }
+    
+    if (config->sjf_max_wait_ms != old->sjf_max_wait_ms) {
+        set_queue_discipline(config->queue_discipline, config->sjf_max_wait_ms);
+    }
+    
+    if (config->checkpoint_interval_ms > 0 && open_checkpoint(0) != 0) {
+        write_log("AVISO: Checkpoint indisponível");
+    }
+}
+
+/*
+ * Recarrega 'filename' (SIGHUP ou alteração detetada pelo inotify)
+ * Com um ficheiro inválido a configuração atual mantém-se
+ * Retorna 0 em caso de sucesso, -1 se o ficheiro for inválido
+ */
+int reload_config(const char *filename, Config *config) {
+    Config next;
+    
+    write_log("A recarregar %s...", filename);
+    
+    if (load_config(filename, &next) != 0) {
+        write_log("AVISO: %s inválido, configuração atual mantida", filename);
+        return -1;
+    }
+    
+    keep_restart_only(config, &next);
+    
+    if (log_changes(config, &next) == 0) {
+        write_log("Configuração sem alterações");
+        return 0;
+    }
+    
+    // Só a thread principal lê 'config'; as threads de triagem e o
+    // autoscaler recebem cópias em apply_changes
+    Config old = *config;
+    *config = next;
+    apply_changes(&old, config);
+    
+    if (frontend_id == 0) {
+        publish_config(config);
+        write_log("Configuração recarregada (versão %u)", atomic_load(&shm_stats->config_version));
+    } else {
+        write_log("Configuração da triagem do front-end %d recarregada", frontend_id);
+    }
+    print_config(config);
+    
+    return 0;
+}
+
+/*
+ * Publica a configuração para os Doctors (no arranque e a cada
+ * recarregamento); cópia e versão mudam juntas, com o mutex
+ */
+void publish_config(const Config *config) {
+    if (shm_stats == NULL) {
+        return;
+    }
+    
+    lock_mutex(&shm_stats->mutex, LOCK_SHM_STATS);
+    shm_stats->config = *config;
+    atomic_fetch_add(&shm_stats->config_version, 1);
+    pthread_mutex_unlock(&shm_stats->mutex);
+}
+
+/*
+ * Doctors: copia a configuração publicada se a versão mudou desde a
+ * última cópia (no caso comum é só uma leitura atómica)
+ * Retorna 1 se 'config' foi atualizada, 0 caso contrário
+ */
+int refresh_config(Config *config, unsigned int *version) {
+    if (shm_stats == NULL ||
+        atomic_load_explicit(&shm_stats->config_version, memory_order_acquire) == *version) {
+        return 0;
+    }
+    
+    lock_mutex(&shm_stats->mutex, LOCK_SHM_STATS);
+    *config = shm_stats->config;
+    *version = atomic_load(&shm_stats->config_version);
+    pthread_mutex_unlock(&shm_stats->mutex);
+    
+    return 1;
+}
@@ -0,0 +1,25 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ */
+
+#ifndef RELOAD_H
+#define RELOAD_H
+
+#include "config.h"
+
+/* Funções para observar config.txt (inotify no diretório atual) */
+int open_config_watch(const char *filename);
+int config_watch_changed(int watch_fd);
+void close_config_watch(int watch_fd);
+
+/* Recarregamento a quente (Admission): lê, valida e aplica as alterações */
+int reload_config(const char *filename, Config *config);
+
+/* Bloco versionado da configuração na memória partilhada */
+void publish_config(const Config *config);
+int refresh_config(Config *config, unsigned int *version);
+
+#endif // RELOAD_H
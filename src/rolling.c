@@ -0,0 +1,175 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "rolling.h"
+#include "shm.h"
+
+static long long monotonic_second() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec;
+}
+
+/*
+ * Inicializa as janelas (chamado pelo Admission ao criar a SHM)
+ */
+void rolling_init(RollingStats *rolling) {
+    rolling->start_second = monotonic_second();
+    atomic_store(&rolling->last_second, rolling->start_second);
+    for (int i = 0; i < ROLLING_SLOTS; i++) {
+        atomic_store(&rolling->ring[i].second, -1);
+    }
+}
+
+/*
+ * Primeiro evento de um segundo novo: guarda os totais no início desse
+ * segundo (antes de somar o próprio evento). Só quem ganha o CAS escreve
+ */
+static void rolling_tick(RollingStats *rolling) {
+    long long second = monotonic_second();
+    long long last = atomic_load_explicit(&rolling->last_second, memory_order_relaxed);
+    
+    while (second > last) {
+        if (atomic_compare_exchange_weak_explicit(&rolling->last_second, &last, second,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+            RollingSnapshot *snapshot = &rolling->ring[second % ROLLING_SLOTS];
+            atomic_store_explicit(&snapshot->second, -1, memory_order_relaxed);
+            atomic_thread_fence(memory_order_release);
+            for (int c = 0; c < ROLL_NUM_COUNTERS; c++) {
+                atomic_store_explicit(&snapshot->totals[c],
+                    atomic_load_explicit(&rolling->totals[c], memory_order_relaxed),
+                    memory_order_relaxed);
+            }
+            atomic_store_explicit(&snapshot->second, second, memory_order_release);
+            return;
+        }
+    }
+}
+
+static void rolling_add(int counter, long long amount) {
+    atomic_fetch_add_explicit(&shm_stats->rolling.totals[counter], amount, memory_order_relaxed);
+}
+
+void rolling_record_ingest(int arrivals, int dropped) {
+    if (shm_stats == NULL || arrivals <= 0) {
+        return;
+    }
+    
+    rolling_tick(&shm_stats->rolling);
+    rolling_add(ROLL_ARRIVALS, arrivals);
+    if (dropped > 0) {
+        rolling_add(ROLL_DROPPED, dropped);
+    }
+}
+
+void rolling_record_triaged(double wait_time) {
+    if (shm_stats == NULL) {
+        return;
+    }
+    
+    rolling_tick(&shm_stats->rolling);
+    rolling_add(ROLL_TRIAGED, 1);
+    rolling_add(ROLL_WAIT_TRIAGE_US, (long long)(wait_time * 1e6));
+}
+
+void rolling_record_attended(double wait_time) {
+    if (shm_stats == NULL) {
+        return;
+    }
+    
+    rolling_tick(&shm_stats->rolling);
+    rolling_add(ROLL_ATTENDED, 1);
+    rolling_add(ROLL_WAIT_DOCTOR_US, (long long)(wait_time * 1e6));
+}
+
+/*
+ * Totais no início do segundo 'target' (sendo 'now' o segundo atual):
+ * o primeiro instantâneo em [target, now]; sem nenhum, não houve eventos
+ * desde 'target' e valem os totais atuais
+ */
+static void totals_at(const RollingStats *rolling, long long target, long long now,
+                      long long totals[ROLL_NUM_COUNTERS]) {
+    if (target <= rolling->start_second) {
+        memset(totals, 0, ROLL_NUM_COUNTERS * sizeof(long long));
+        return;
+    }
+    
+    for (long long second = target; second <= now; second++) {
+        const RollingSnapshot *snapshot = &rolling->ring[second % ROLLING_SLOTS];
+        if (atomic_load_explicit(&snapshot->second, memory_order_acquire) != second) {
+            continue;
+        }
+        for (int c = 0; c < ROLL_NUM_COUNTERS; c++) {
+            totals[c] = atomic_load_explicit(&snapshot->totals[c], memory_order_relaxed);
+        }
+        // Reescrito entretanto (leitura atrasada mais de ROLLING_SLOTS s): ignorar
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&snapshot->second, memory_order_relaxed) == second) {
+            return;
+        }
+    }
+    
+    for (int c = 0; c < ROLL_NUM_COUNTERS; c++) {
+        totals[c] = atomic_load_explicit(&rolling->totals[c], memory_order_relaxed);
+    }
+}
+
+/*
+ * Taxas e médias dos últimos 'seconds' segundos completos
+ * (seconds = 0: desde o arranque, incluindo o segundo atual)
+ * Retorna 0 em caso de sucesso, -1 sem SHM ou ainda sem um segundo completo
+ */
+int get_rolling_window(int seconds, RollingWindow *window) {
+    if (shm_stats == NULL || seconds < 0 || seconds > ROLLING_SLOTS - 2) {
+        return -1;
+    }
+    
+    const RollingStats *rolling = &shm_stats->rolling;
+    long long now = monotonic_second();
+    long long from[ROLL_NUM_COUNTERS], to[ROLL_NUM_COUNTERS];
+    
+    if (seconds == 0) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        window->seconds = (ts.tv_sec - rolling->start_second) + ts.tv_nsec / 1e9;
+        memset(from, 0, sizeof(from));
+        for (int c = 0; c < ROLL_NUM_COUNTERS; c++) {
+            to[c] = atomic_load_explicit(&rolling->totals[c], memory_order_relaxed);
+        }
+    } else {
+        long long start = now - seconds;
+        if (start < rolling->start_second) {
+            start = rolling->start_second;
+        }
+        window->seconds = (double)(now - start);
+        totals_at(rolling, start, now, from);
+        totals_at(rolling, now, now, to);
+    }
+    
+    if (window->seconds <= 0) {
+        return -1;
+    }
+    
+    long long delta[ROLL_NUM_COUNTERS];
+    for (int c = 0; c < ROLL_NUM_COUNTERS; c++) {
+        delta[c] = to[c] - from[c];
+    }
+    
+    window->arrivals_per_s = delta[ROLL_ARRIVALS] / window->seconds;
+    window->dropped_per_s = delta[ROLL_DROPPED] / window->seconds;
+    window->triaged_per_s = delta[ROLL_TRIAGED] / window->seconds;
+    window->attended_per_s = delta[ROLL_ATTENDED] / window->seconds;
+    window->wait_triage_ms = (delta[ROLL_TRIAGED] > 0) ?
+        delta[ROLL_WAIT_TRIAGE_US] / 1e3 / delta[ROLL_TRIAGED] : -1;
+    window->wait_doctor_ms = (delta[ROLL_ATTENDED] > 0) ?
+        delta[ROLL_WAIT_DOCTOR_US] / 1e3 / delta[ROLL_ATTENDED] : -1;
+    
+    return 0;
+}
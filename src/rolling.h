@@ -0,0 +1,58 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ */
+
+#ifndef ROLLING_H
+#define ROLLING_H
+
+#include <stdatomic.h>
+
+#define ROLLING_SLOTS 64            // Segundos guardados (janela máxima: 60 s)
+
+/* Contadores das janelas */
+#define ROLL_ARRIVALS       0       // Pacientes recebidos (aceites + descartados)
+#define ROLL_DROPPED        1       // Descartados (fila de triagem cheia)
+#define ROLL_TRIAGED        2
+#define ROLL_ATTENDED       3
+#define ROLL_WAIT_TRIAGE_US 4       // Soma das esperas antes da triagem (µs)
+#define ROLL_WAIT_DOCTOR_US 5       // Soma das esperas entre triagem e atendimento (µs)
+#define ROLL_NUM_COUNTERS   6
+
+/* Totais no início de um segundo (CLOCK_MONOTONIC) */
+typedef struct {
+    atomic_llong second;            // Segundo a que pertence (-1 = a ser escrito)
+    atomic_llong totals[ROLL_NUM_COUNTERS];
+} RollingSnapshot;
+
+/* Na memória partilhada: totais acumulados (só fetch_add) e, por segundo,
+ * os totais no seu início; uma janela é a diferença entre dois instantâneos,
+ * por isso nenhum balde precisa de ser limpo */
+typedef struct {
+    long long start_second;         // Segundo da criação da SHM
+    atomic_llong last_second;       // Último segundo com instantâneo
+    atomic_llong totals[ROLL_NUM_COUNTERS];
+    RollingSnapshot ring[ROLLING_SLOTS];
+} RollingStats;
+
+/* Taxas e médias de uma janela */
+typedef struct {
+    double seconds;                 // Duração efetiva (menor no arranque)
+    double arrivals_per_s;
+    double dropped_per_s;
+    double triaged_per_s;
+    double attended_per_s;
+    double wait_triage_ms;          // Médias (-1 = sem pacientes na janela)
+    double wait_doctor_ms;
+} RollingWindow;
+
+/* Funções para as estatísticas por janela (sem locks) */
+void rolling_init(RollingStats *rolling);
+void rolling_record_ingest(int arrivals, int dropped);
+void rolling_record_triaged(double wait_time);
+void rolling_record_attended(double wait_time);
+int get_rolling_window(int seconds, RollingWindow *window);
+
+#endif // ROLLING_H
@@ -0,0 +1,291 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <errno.h>
+#include <time.h>
+#include <stdatomic.h>
+#include <sys/file.h>
+#include "scaleout.h"
+#include "shm.h"
+#include "msq.h"
+#include "log.h"
+
+#define DEBUG
+
+/* Identificação desta instância */
+int frontend_id = 0;
+
+/* Ficheiro de eleição: o coordenador mantém o flock até terminar */
+static int lock_fd = -1;
+
+/* PID do coordenador a que este front-end se juntou */
+static pid_t coordinator = 0;
+
+/*
+ * Nome de um recurso desta instância (pipes, socket, log)
+ */
+void instance_name(const char *base, char *name, size_t size) {
+    if (frontend_id == 0) {
+        snprintf(name, size, "%s", base);
+    } else {
+        snprintf(name, size, "%s.%d", base, frontend_id);
+    }
+}
+
+/*
+ * Tenta ficar com o flock do ficheiro de eleição (libertado pelo kernel
+ * quando o processo termina, mesmo sem terminação controlada)
+ * Retorna 1 se esta instância é o coordenador, 0 se já existe um, -1 em caso de erro
+ */
+int elect_coordinator() {
+    lock_fd = open(SCALEOUT_LOCK_FILE, O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+    if (lock_fd == -1) {
+        perror("Erro ao abrir ficheiro de eleição");
+        return -1;
+    }
+    
+    if (flock(lock_fd, LOCK_EX | LOCK_NB) == -1) {
+        if (errno == EWOULDBLOCK) {
+            return 0;   // O descritor fica aberto para ler o PID do coordenador
+        }
+        perror("Erro ao obter lock de coordenador (flock)");
+        close(lock_fd);
+        lock_fd = -1;
+        return -1;
+    }
+    
+    // Apagar o PID de um coordenador anterior que não terminou de forma controlada
+    if (ftruncate(lock_fd, 0) == -1) {
+        perror("Erro ao limpar ficheiro de eleição");
+    }
+    
+    return 1;
+}
+
+/*
+ * Coordenador pronto (memória partilhada, MSQ e Doctors criados): publica
+ * o PID na memória partilhada e depois no ficheiro de eleição, que é o
+ * que os front-ends esperam
+ */
+void announce_coordinator() {
+    char text[32];
+    int length = snprintf(text, sizeof(text), "%d\n", getpid());
+    
+    atomic_store(&shm_stats->coordinator_pid, getpid());
+    
+    if (lock_fd == -1 || pwrite(lock_fd, text, length, 0) != length) {
+        write_log("AVISO: Falha ao anunciar o coordenador em %s", SCALEOUT_LOCK_FILE);
+    }
+}
+
+/*
+ * Coordenador a terminar: deixa de aceitar novos front-ends
+ * (o flock só é libertado com o fim do processo)
+ */
+void retire_coordinator() {
+    if (lock_fd == -1 || shm_stats == NULL) {
+        return;
+    }
+    
+    atomic_store(&shm_stats->coordinator_pid, 0);
+    if (ftruncate(lock_fd, 0) == -1) {
+        write_log("AVISO: Falha ao limpar %s", SCALEOUT_LOCK_FILE);
+    }
+}
+
+/*
+ * Pede a terminação (SIGINT) aos front-ends registados; cada um escoa a
+ * sua triagem para a fila de atendimento e sai do registo
+ * Retorna o número de front-ends avisados
+ */
+int signal_frontends() {
+    int signalled = 0;
+    
+    for (int i = 0; i < MAX_FRONTENDS; i++) {
+        pid_t pid = atomic_load(&shm_stats->frontend_pids[i]);
+        if (pid <= 0) {
+            continue;
+        }
+        
+        if (kill(pid, SIGINT) == 0) {
+            signalled++;
+        } else if (errno == ESRCH) {
+            atomic_store(&shm_stats->frontend_pids[i], 0);   // Front-end que morreu
+        }
+    }
+    
+    if (signalled > 0) {
+        write_log("Terminação pedida a %d front-ends", signalled);
+    }
+    
+    return signalled;
+}
+
+/*
+ * Número de front-ends registados que ainda estão em execução
+ */
+int running_frontends() {
+    int running = 0;
+    
+    for (int i = 0; i < MAX_FRONTENDS; i++) {
+        pid_t pid = atomic_load(&shm_stats->frontend_pids[i]);
+        if (pid > 0 && kill(pid, 0) == 0) {
+            running++;
+        }
+    }
+    
+    return running;
+}
+
+/*
+ * Espera até 'timeout_ms' que os front-ends saiam do registo
+ * Retorna 0 se todos terminaram, -1 caso contrário
+ */
+int wait_frontends(int timeout_ms) {
+    struct timespec pause = {0, 10 * 1000000L};   // 10 ms entre verificações
+    int running = running_frontends();
+    
+    for (int waited_ms = 0; running > 0 && waited_ms < timeout_ms; waited_ms += 10) {
+        nanosleep(&pause, NULL);
+        running = running_frontends();
+    }
+    
+    if (running > 0) {
+        write_log("AVISO: %d front-ends não terminaram a tempo", running);
+        return -1;
+    }
+    
+    return 0;
+}
+
+/*
+ * Pacientes aceites pelos front-ends que já saíram
+ */
+long get_frontend_accepted() {
+    return (shm_stats != NULL) ? atomic_load(&shm_stats->frontend_accepted) : 0;
+}
+
+/*
+ * Lê o PID anunciado pelo coordenador (0 se ainda não está pronto)
+ */
+static pid_t read_coordinator_pid() {
+    char text[32];
+    ssize_t length = pread(lock_fd, text, sizeof(text) - 1, 0);
+    
+    if (length <= 0) {
+        return 0;
+    }
+    text[length] = '\0';
+    
+    return (pid_t)atoi(text);
+}
+
+/*
+ * Ocupa uma posição livre do registo de front-ends (ou a de um
+ * front-end que morreu sem sair do registo)
+ * Retorna o ID do front-end (1..MAX_FRONTENDS), -1 se o registo está cheio
+ */
+static int claim_frontend_slot() {
+    for (int i = 0; i < MAX_FRONTENDS; i++) {
+        int expected = atomic_load(&shm_stats->frontend_pids[i]);
+        
+        if (expected > 0 && (kill(expected, 0) == 0 || errno != ESRCH)) {
+            continue;
+        }
+        
+        if (atomic_compare_exchange_strong(&shm_stats->frontend_pids[i], &expected, getpid())) {
+            return i + 1;
+        }
+    }
+    
+    return -1;
+}
+
+/*
+ * Front-end: espera até 'timeout_ms' que o coordenador esteja pronto,
+ * anexa à memória partilhada e à MSQ e regista-se
+ * Chamado antes de existir o log (erros vão para stderr)
+ * Retorna o ID do front-end, -1 em caso de erro
+ */
+int join_coordinator(int timeout_ms) {
+    struct timespec pause = {0, 100 * 1000000L};   // 100 ms entre verificações
+    pid_t pid;
+    int waited_ms = 0;
+    
+    while ((pid = read_coordinator_pid()) <= 0 || kill(pid, 0) == -1) {
+        if (waited_ms >= timeout_ms) {
+            fprintf(stderr, "ERRO: Coordenador não ficou pronto em %d ms\n", timeout_ms);
+            return -1;
+        }
+        nanosleep(&pause, NULL);
+        waited_ms += 100;
+    }
+    
+    if (attach_shared_memory() != 0) {
+        return -1;
+    }
+    
+    // O ficheiro de eleição e a memória partilhada têm de ser do mesmo coordenador
+    if (atomic_load(&shm_stats->coordinator_pid) != pid) {
+        fprintf(stderr, "ERRO: Memória partilhada não pertence ao coordenador (PID %d)\n", pid);
+        detach_shared_memory();
+        return -1;
+    }
+    
+    if (attach_message_queue() != 0) {
+        perror("Erro ao aceder à fila de mensagens do coordenador");
+        detach_shared_memory();
+        return -1;
+    }
+    
+    frontend_id = claim_frontend_slot();
+    if (frontend_id == -1) {
+        fprintf(stderr, "ERRO: Já existem %d front-ends ligados ao coordenador\n", MAX_FRONTENDS);
+        frontend_id = 0;
+        detach_shared_memory();
+        return -1;
+    }
+    coordinator = pid;
+    
+    #ifdef DEBUG
+    printf("[DEBUG] Front-end %d ligado ao coordenador (PID: %d)\n", frontend_id, pid);
+    #endif
+    
+    return frontend_id;
+}
+
+/*
+ * Front-end: o coordenador ainda existe?
+ */
+int coordinator_alive() {
+    return coordinator > 0 && (kill(coordinator, 0) == 0 || errno == EPERM);
+}
+
+/*
+ * Front-end a terminar: soma os pacientes aceites ao total do
+ * coordenador, sai do registo e desanexa (sem destruir nada)
+ */
+void leave_coordinator(long accepted) {
+    if (shm_stats != NULL && frontend_id > 0) {
+        atomic_fetch_add(&shm_stats->frontend_accepted, accepted);
+        
+        int self = getpid();
+        atomic_compare_exchange_strong(&shm_stats->frontend_pids[frontend_id - 1], &self, 0);
+        detach_shared_memory();
+    }
+    
+    if (lock_fd != -1) {
+        close(lock_fd);
+        lock_fd = -1;
+    }
+}
@@ -0,0 +1,39 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ */
+
+#ifndef SCALEOUT_H
+#define SCALEOUT_H
+
+#include <stddef.h>
+
+/* Ficheiro de eleição do coordenador (flock; contém o PID quando está pronto) */
+#define SCALEOUT_LOCK_FILE "/tmp/urgencias.lock"
+#define SCALEOUT_JOIN_TIMEOUT_MS 10000   // Espera de um front-end pelo coordenador
+#define SCALEOUT_STOP_GRACE_MS 2000      // Espera pelos front-ends depois da drenagem
+#define INSTANCE_NAME_MAX 108            // Como sun_path (nomes de pipes, socket e log)
+
+/* 0 = coordenador (ou instância única), 1..MAX_FRONTENDS = front-end */
+extern int frontend_id;
+
+/* Nome de um recurso desta instância: 'base' no coordenador, "base.N" no front-end N */
+void instance_name(const char *base, char *name, size_t size);
+
+/* Coordenador */
+int elect_coordinator();
+void announce_coordinator();
+void retire_coordinator();
+int signal_frontends();
+int running_frontends();
+int wait_frontends(int timeout_ms);
+long get_frontend_accepted();
+
+/* Front-end */
+int join_coordinator(int timeout_ms);
+int coordinator_alive();
+void leave_coordinator(long accepted);
+
+#endif // SCALEOUT_H
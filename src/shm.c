@@ -13,7 +13,10 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <math.h>
 #include "shm.h"
+#include "affinity.h"
+#include "lockstat.h"
 
 #define DEBUG 
 
@@ -24,6 +27,17 @@
 Statistics *shm_stats = NULL;
 int shm_fd = -1;
 
+/* Nó NUMA preferido para a memória partilhada (-1 = política por omissão) */
+static int shm_numa_node = -1;
+
+/*
+ * Define o nó NUMA onde a memória partilhada será criada
+ * Deve ser chamada antes de create_shared_memory()
+ */
+void set_shared_memory_numa_node(int node) {
+    shm_numa_node = node;
+}
+
 /*
  * Cria e inicializa a memória partilhada
  * Retorna 0 em caso de sucesso, -1 em caso de erro
@@ -63,8 +77,12 @@ int create_shared_memory() {
         return -1;
     }
     
+    // Colocar as páginas no nó NUMA dos Doctors antes de serem tocadas
+    bind_memory_to_node(shm_stats, SHM_SIZE, shm_numa_node, 0);
+    
     // Inicializar a estrutura de estatísticas
     memset(shm_stats, 0, SHM_SIZE);
+    rolling_init(&shm_stats->rolling);
     
     // Inicializar o mutex com atributos para memória partilhada
     pthread_mutexattr_t mutex_attr;
@@ -82,6 +100,26 @@ int create_shared_memory() {
     
     pthread_mutexattr_destroy(&mutex_attr);
     
+    // Fila SJF (só usada com QUEUE_DISCIPLINE = sjf)
+    if (dq_init(&shm_stats->doctor_queue) != 0) {
+        pthread_mutex_destroy(&shm_stats->mutex);
+        munmap(shm_stats, SHM_SIZE);
+        close(shm_fd);
+        shm_unlink(SHM_NAME);
+        return -1;
+    }
+    
+    // Semáforo partilhado entre processos para ativar Doctors em espera
+    if (sem_init(&shm_stats->warm_activate, 1, 0) != 0) {
+        perror("Erro ao inicializar semáforo da pool de Doctors");
+        dq_destroy(&shm_stats->doctor_queue);
+        pthread_mutex_destroy(&shm_stats->mutex);
+        munmap(shm_stats, SHM_SIZE);
+        close(shm_fd);
+        shm_unlink(SHM_NAME);
+        return -1;
+    }
+    
     #ifdef DEBUG
     printf("[DEBUG] Memória partilhada criada com sucesso\n");
     printf("[DEBUG] Nome: %s\n", SHM_NAME);
@@ -155,9 +193,11 @@ void destroy_shared_memory() {
     printf("[DEBUG] A destruir memória partilhada...\n");
     #endif
     
-    // Destruir o mutex
+    // Destruir o mutex e o semáforo
     if (shm_stats != NULL && shm_stats != MAP_FAILED) {
         pthread_mutex_destroy(&shm_stats->mutex);
+        sem_destroy(&shm_stats->warm_activate);
+        dq_destroy(&shm_stats->doctor_queue);
     }
     
     // Desanexar
@@ -182,7 +222,7 @@ void update_triaged_stats(double wait_time) {
         return;
     }
     
-    pthread_mutex_lock(&shm_stats->mutex);
+    lock_mutex(&shm_stats->mutex, LOCK_SHM_STATS);
     
     shm_stats->total_triaged++;
     shm_stats->total_wait_triage += wait_time;
@@ -193,22 +233,57 @@ void update_triaged_stats(double wait_time) {
     #endif
     
     pthread_mutex_unlock(&shm_stats->mutex);
+    
+    rolling_record_triaged(wait_time);
+}
+
+/*
+ * Bucket do histograma de tempo no sistema (ver latency_hist em shm.h)
+ */
+static int latency_bucket(double seconds) {
+    double us = seconds * 1e6;
+    if (us < 1.0) {
+        return 0;
+    }
+    
+    int bucket = (int)ceil(log2(us) * 4);
+    if (bucket < 1) {
+        return 1;
+    }
+    return (bucket < LATENCY_HIST_BUCKETS) ? bucket : LATENCY_HIST_BUCKETS - 1;
 }
 
 /*
  * Atualiza estatísticas após atendimento de um paciente
+ * lateness: segundos entre o prazo (SLA) e o início do atendimento
  */
-void update_attended_stats(double wait_time, double total_time) {
+void update_attended_stats(int priority, double wait_time, double total_time, double lateness) {
     if (shm_stats == NULL) {
         fprintf(stderr, "ERRO: Memória partilhada não inicializada\n");
         return;
     }
     
-    pthread_mutex_lock(&shm_stats->mutex);
+    lock_mutex(&shm_stats->mutex, LOCK_SHM_STATS);
     
     shm_stats->total_attended++;
     shm_stats->total_wait_doctor += wait_time;
     shm_stats->total_time_system += total_time;
+    shm_stats->latency_hist[latency_bucket(total_time)]++;
+    
+    if (priority >= 1 && priority <= NUM_PRIORITIES) {
+        shm_stats->attended_by_priority[priority - 1]++;
+        shm_stats->wait_doctor_by_priority[priority - 1] += wait_time;
+        
+        // Atraso em relação ao prazo (<= 0 = dentro do SLA)
+        if (lateness > 0) {
+            int bucket = 0;
+            for (double limit = 0.01; bucket < SLA_HIST_BUCKETS - 1 && lateness > limit; limit *= 10) {
+                bucket++;
+            }
+            shm_stats->sla_missed[priority - 1]++;
+            shm_stats->lateness_hist[priority - 1][bucket]++;
+        }
+    }
     
     #ifdef DEBUG
     printf("[DEBUG] Estatísticas atualizadas: attended=%d, wait_doctor=%.2f, time_system=%.2f\n",
@@ -216,6 +291,233 @@ void update_attended_stats(double wait_time, double total_time) {
     #endif
     
     pthread_mutex_unlock(&shm_stats->mutex);
+    
+    rolling_record_attended(wait_time);
+}
+
+/*
+ * Percentil do histograma de tempo no sistema (com o mutex já adquirido)
+ */
+static double latency_percentile_locked(double fraction) {
+    long total = 0;
+    for (int i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+        total += shm_stats->latency_hist[i];
+    }
+    if (total == 0) {
+        return -1;
+    }
+    
+    long rank = (long)ceil(fraction * total);
+    long seen = 0;
+    for (int i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+        seen += shm_stats->latency_hist[i];
+        if (seen >= rank && seen > 0) {
+            return pow(2.0, i / 4.0) * 1e-6;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Percentil (fraction entre 0 e 1) do tempo total no sistema, em segundos
+ * Devolve o limite superior do bucket, ou seja, um erro de até ~19% por excesso
+ * Retorna -1 se ainda não houver pacientes atendidos
+ */
+double get_latency_percentile(double fraction) {
+    if (shm_stats == NULL) {
+        return -1;
+    }
+    
+    pthread_mutex_lock(&shm_stats->mutex);
+    double result = latency_percentile_locked(fraction);
+    pthread_mutex_unlock(&shm_stats->mutex);
+    
+    return result;
+}
+
+/*
+ * Linha da tabela de utilização de uma thread de triagem (id = 1.., mais
+ * frontend_id * USAGE_TRIAGE_SLOTS num front-end) ou de um Doctor
+ * (id > 0 permanente, id < 0 temporário: linha comum)
+ * Retorna NULL sem SHM ou com o ID fora da tabela
+ */
+WorkerUsage* get_worker_usage(int kind, int id) {
+    if (shm_stats == NULL) {
+        return NULL;
+    }
+    
+    if (kind == USAGE_TRIAGE) {
+        return (id >= 1 && id <= (MAX_FRONTENDS + 1) * USAGE_TRIAGE_SLOTS) ?
+               &shm_stats->triage_usage[id - 1] : NULL;
+    }
+    if (id < 0) {
+        return &shm_stats->doctor_usage[USAGE_DOCTOR_SLOTS];
+    }
+    return (id >= 1 && id <= USAGE_DOCTOR_SLOTS) ? &shm_stats->doctor_usage[id - 1] : NULL;
+}
+
+static long long monotonic_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/*
+ * Início de uma thread/processo: o tempo livre conta a partir daqui
+ */
+void worker_usage_start(WorkerUsage *usage, long long *mark_ns) {
+    *mark_ns = monotonic_ns();
+    if (usage == NULL) {
+        return;
+    }
+    
+    atomic_store_explicit(&usage->pid, getpid(), memory_order_relaxed);
+    atomic_store_explicit(&usage->last_mark_ns, *mark_ns, memory_order_relaxed);
+    atomic_fetch_add_explicit(&usage->active, 1, memory_order_relaxed);
+}
+
+/*
+ * Um paciente tratado em [busy_start, busy_end] (CLOCK_MONOTONIC): o tempo
+ * desde a última marca até busy_start conta como livre
+ */
+void worker_usage_add(WorkerUsage *usage, long long *mark_ns,
+                      const struct timespec *busy_start, const struct timespec *busy_end) {
+    long long start_ns = (long long)busy_start->tv_sec * 1000000000LL + busy_start->tv_nsec;
+    long long end_ns = (long long)busy_end->tv_sec * 1000000000LL + busy_end->tv_nsec;
+    if (usage != NULL) {
+        if (start_ns > *mark_ns) {
+            atomic_fetch_add_explicit(&usage->idle_ns, start_ns - *mark_ns, memory_order_relaxed);
+        }
+        atomic_fetch_add_explicit(&usage->busy_ns, end_ns - start_ns, memory_order_relaxed);
+        atomic_fetch_add_explicit(&usage->handled, 1, memory_order_relaxed);
+        atomic_store_explicit(&usage->last_mark_ns, end_ns, memory_order_relaxed);
+    }
+    *mark_ns = end_ns;
+}
+
+/*
+ * Fim de uma thread/processo: fecha o tempo livre desde o último paciente
+ */
+void worker_usage_stop(WorkerUsage *usage, long long *mark_ns) {
+    if (usage == NULL) {
+        return;
+    }
+    
+    long long now_ns = monotonic_ns();
+    if (now_ns > *mark_ns) {
+        atomic_fetch_add_explicit(&usage->idle_ns, now_ns - *mark_ns, memory_order_relaxed);
+    }
+    atomic_store_explicit(&usage->last_mark_ns, now_ns, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&usage->active, 1, memory_order_relaxed);
+    *mark_ns = now_ns;
+}
+
+/*
+ * Uma linha da tabela de utilização; numa linha com um só dono ativo o
+ * tempo desde o último paciente conta já como livre
+ */
+static void print_worker_usage_row(const char *name, WorkerUsage *usage, int shared, long long now_ns) {
+    int active = atomic_load_explicit(&usage->active, memory_order_relaxed);
+    long long handled = atomic_load_explicit(&usage->handled, memory_order_relaxed);
+    long long busy_ns = atomic_load_explicit(&usage->busy_ns, memory_order_relaxed);
+    long long idle_ns = atomic_load_explicit(&usage->idle_ns, memory_order_relaxed);
+    if (active == 0 && handled == 0) {
+        return;
+    }
+    
+    long long last_mark_ns = atomic_load_explicit(&usage->last_mark_ns, memory_order_relaxed);
+    if (active > 0 && !shared && now_ns > last_mark_ns) {
+        idle_ns += now_ns - last_mark_ns;
+    }
+    
+    long long total_ns = busy_ns + idle_ns;
+    printf("║ %-12s%c %9lld %8.2f %8.2f %6.1f%% %8.3f ║\n", name, active > 0 ? '*' : ' ',
+           handled, busy_ns / 1e9, idle_ns / 1e9,
+           (total_ns > 0) ? 100.0 * busy_ns / total_ns : 0.0,
+           (handled > 0) ? busy_ns / 1e6 / handled : 0.0);
+}
+
+static void format_window_wait(char *buffer, size_t size, double wait_ms) {
+    if (wait_ms < 0) {
+        snprintf(buffer, size, "N/A");
+    } else {
+        snprintf(buffer, size, "%.1f", wait_ms);
+    }
+}
+
+/*
+ * Taxas e esperas médias nas últimas janelas e desde o arranque
+ */
+static void print_rolling_windows() {
+    static const int windows[] = {1, 10, 60, 0};
+    
+    printf("╠════════════════════════════════════════════════════════════╣\n");
+    printf("║ Janela  Cheg/s Triag/s Atend/s  Desc/s   Esp.tri   Esp.Doc ║\n");
+    printf("║                                             (ms)      (ms) ║\n");
+    for (size_t i = 0; i < sizeof(windows) / sizeof(windows[0]); i++) {
+        char label[16], wait_triage[16], wait_doctor[16];
+        RollingWindow window;
+        
+        if (windows[i] > 0) {
+            snprintf(label, sizeof(label), "%d s", windows[i]);
+        } else {
+            snprintf(label, sizeof(label), "total");
+        }
+        
+        if (get_rolling_window(windows[i], &window) != 0) {
+            printf("║ %-6s%8s%8s%8s%8s%10s%10s ║\n", label, "N/A", "N/A", "N/A", "N/A", "N/A", "N/A");
+            continue;
+        }
+        
+        format_window_wait(wait_triage, sizeof(wait_triage), window.wait_triage_ms);
+        format_window_wait(wait_doctor, sizeof(wait_doctor), window.wait_doctor_ms);
+        printf("║ %-6s%8.1f%8.1f%8.1f%8.1f%10s%10s ║\n", label, window.arrivals_per_s,
+               window.triaged_per_s, window.attended_per_s, window.dropped_per_s,
+               wait_triage, wait_doctor);
+    }
+}
+
+/*
+ * Tabela de utilização (* = em execução): sem mutex, só leituras atómicas
+ */
+static void print_worker_usage() {
+    long long now_ns = monotonic_ns();
+    char name[16];
+    
+    printf("╠════════════════════════════════════════════════════════════╣\n");
+    printf("║ Utilização    Pacientes  Ocupado    Livre   Util.  Serviço ║\n");
+    printf("║                              (s)      (s)             (ms) ║\n");
+    for (int i = 0; i < (MAX_FRONTENDS + 1) * USAGE_TRIAGE_SLOTS; i++) {
+        int instance = i / USAGE_TRIAGE_SLOTS;
+        if (instance == 0) {
+            snprintf(name, sizeof(name), "Triagem %d", i + 1);
+        } else {
+            // Front-end N: "Triag. N.ID" (cabe na coluna de 12)
+            snprintf(name, sizeof(name), "Triag. %d.%d", instance, i % USAGE_TRIAGE_SLOTS + 1);
+        }
+        print_worker_usage_row(name, &shm_stats->triage_usage[i], 0, now_ns);
+    }
+    for (int i = 0; i < USAGE_DOCTOR_SLOTS; i++) {
+        snprintf(name, sizeof(name), "Doctor %d", i + 1);
+        print_worker_usage_row(name, &shm_stats->doctor_usage[i], 0, now_ns);
+    }
+    print_worker_usage_row("Doctors TEMP", &shm_stats->doctor_usage[USAGE_DOCTOR_SLOTS], 1, now_ns);
+}
+
+/*
+ * Lê os contadores de triados e atendidos de forma consistente
+ */
+void get_stats_counters(int *triaged, int *attended) {
+    if (shm_stats == NULL) {
+        *triaged = 0;
+        *attended = 0;
+        return;
+    }
+    
+    pthread_mutex_lock(&shm_stats->mutex);
+    *triaged = shm_stats->total_triaged;
+    *attended = shm_stats->total_attended;
+    pthread_mutex_unlock(&shm_stats->mutex);
 }
 
 /*
@@ -248,11 +550,60 @@ void print_statistics() {
         double avg_total_time = shm_stats->total_time_system / shm_stats->total_attended;
         printf("║ Tempo médio entre triagem e atendimento:      %10.2f s ║\n", avg_wait_doctor);
         printf("║ Tempo médio total no sistema:                 %10.2f s ║\n", avg_total_time);
+        printf("║ Tempo total no sistema p50 / p99:   %8.1f / %8.1f ms ║\n",
+               latency_percentile_locked(0.50) * 1000, latency_percentile_locked(0.99) * 1000);
     } else {
         printf("║ Tempo médio entre triagem e atendimento:             N/A ║\n");
         printf("║ Tempo médio total no sistema:                        N/A ║\n");
+        printf("║ Tempo total no sistema p50 / p99:                    N/A ║\n");
     }
     
+    printf("╠════════════════════════════════════════════════════════════╣\n");
+    printf("║ Prioridade   Em fila   Atendidos    Espera até atendimento ║\n");
+    for (int p = 0; p < NUM_PRIORITIES; p++) {
+        int attended = shm_stats->attended_by_priority[p];
+        if (attended > 0) {
+            printf("║     %d       %7d   %9d   %22.2f s ║\n", p + 1,
+                   atomic_load(&shm_stats->queue_depth[p]), attended,
+                   shm_stats->wait_doctor_by_priority[p] / attended);
+        } else {
+            printf("║     %d       %7d   %9d                        N/A ║\n", p + 1,
+                   atomic_load(&shm_stats->queue_depth[p]), attended);
+        }
+    }
+    printf("╠════════════════════════════════════════════════════════════╣\n");
+    printf("║ SLA: atendimentos iniciados fora do prazo (por atraso)   ║\n");
+    printf("║ Prio   Falhas      %%  ≤10ms ≤100ms    ≤1s   ≤10s   >10s  ║\n");
+    for (int p = 0; p < NUM_PRIORITIES; p++) {
+        int attended = shm_stats->attended_by_priority[p];
+        int missed = shm_stats->sla_missed[p];
+        printf("║ %4d   %6d %5.1f%% %6d %6d %6d %6d %6d  ║\n", p + 1, missed,
+               (attended > 0) ? 100.0 * missed / attended : 0.0,
+               shm_stats->lateness_hist[p][0], shm_stats->lateness_hist[p][1],
+               shm_stats->lateness_hist[p][2], shm_stats->lateness_hist[p][3],
+               shm_stats->lateness_hist[p][4]);
+    }
+    printf("╠════════════════════════════════════════════════════════════╣\n");
+    printf("║ Doctors temporários (ativos / alvo):         %4d / %4d ║\n",
+           atomic_load(&shm_stats->temp_doctors), atomic_load(&shm_stats->temp_doctors_target));
+    
+    // Grupos de Doctors (DOCTOR_GROUPS): pacientes em fila e roubados
+    if (shm_stats->num_groups > 1) {
+        printf("╠════════════════════════════════════════════════════════════╣\n");
+        for (int g = 0; g < shm_stats->num_groups; g++) {
+            int queued = 0;
+            for (int p = 0; p < NUM_PRIORITIES; p++) {
+                queued += atomic_load(&shm_stats->lane_depth[g * NUM_PRIORITIES + p]);
+            }
+            printf("║ Grupo %d (%d-%d, %3d Doctors):  em fila %5d  roubos %5lld ║\n",
+                   g + 1, shm_stats->group_low[g], shm_stats->group_high[g],
+                   shm_stats->group_doctors[g], queued, atomic_load(&shm_stats->steals[g]));
+        }
+    }
+    
+    print_rolling_windows();
+    print_worker_usage();
+    
     printf("╚════════════════════════════════════════════════════════════╝\n");
     printf("\n");
     
@@ -10,6 +10,36 @@
 
 #include <sys/types.h>
 #include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include "patient.h"
+#include "config.h"
+#include "dqueue.h"
+#include "rolling.h"
+
+#define QUEUE_AGE_RING 1024   // Instantes de entrada guardados por lane
+#define SLA_HIST_BUCKETS 5    // Atraso: <=10ms, <=100ms, <=1s, <=10s, >10s
+#define LATENCY_HIST_BUCKETS 112  // Tempo no sistema: 4 buckets por potência de 2, 1µs a ~268s
+#define USAGE_TRIAGE_SLOTS 100    // Threads de triagem com linha própria, por instância (= TRIAGE_MAX_THREADS)
+#define USAGE_DOCTOR_SLOTS 256    // Doctors permanentes com linha própria (ID 1..256)
+#define MAX_FRONTENDS 8           // Front-ends de Admission no modo scale-out
+#define TEMP_DOCTOR_SLOTS 256     // Posições da tabela de temporários (= TEMP_DOCTOR_MAX_PIDS)
+
+/* Tipos de linha da tabela de utilização */
+#define USAGE_TRIAGE 0
+#define USAGE_DOCTOR 1
+
+/* Utilização de uma thread de triagem ou de um Doctor (ns, CLOCK_MONOTONIC)
+ * Acumulada por ID ao longo do programa (turnos e reutilizações da posição);
+ * os Doctors temporários partilham uma linha */
+typedef struct {
+    atomic_int active;              // Threads/processos desta linha em execução
+    atomic_int pid;                 // Último processo a publicar
+    atomic_llong busy_ns;           // A tratar um paciente
+    atomic_llong idle_ns;           // À espera de paciente (até ao último paciente)
+    atomic_llong handled;           // Pacientes tratados
+    atomic_llong last_mark_ns;      // Fim do último intervalo contabilizado
+} WorkerUsage;
 
 /* Estrutura para guardar estatísticas na memória partilhada */
 typedef struct {
@@ -22,8 +52,81 @@ typedef struct {
     double total_wait_doctor;       // Tempo total de espera entre triagem e atendimento
     double total_time_system;       // Tempo total no sistema (chegada até saída)
     
+    // Desagregação por prioridade (índice = prioridade - 1)
+    int attended_by_priority[NUM_PRIORITIES];
+    double wait_doctor_by_priority[NUM_PRIORITIES];
+    
+    // SLA (SLA_TARGET_MS): atendimentos iniciados depois do prazo e
+    // histograma do atraso, por prioridade
+    int sla_missed[NUM_PRIORITIES];
+    int lateness_hist[NUM_PRIORITIES][SLA_HIST_BUCKETS];
+    
+    // Histograma do tempo total no sistema (para percentis): o bucket i > 0
+    // conta tempos até 2^(i/4) µs, o bucket 0 tempos abaixo de 1 µs
+    int latency_hist[LATENCY_HIST_BUCKETS];
+    
     // Mutex para sincronização
     pthread_mutex_t mutex;
+    
+    // Pool de Doctors em espera (pré-anexados)
+    sem_t warm_activate;            // Cada sem_post ativa um Doctor em espera
+    atomic_int warm_activated[TEMP_DOCTOR_SLOTS]; // Por posição: 1 depois de o Doctor acordar
+    atomic_int next_temp_doctor_id; // Último ID atribuído a um Doctor temporário
+    
+    // Controlador de pico (Doctors temporários)
+    atomic_int temp_doctors;        // Temporários em atividade (ativados ou lançados)
+    atomic_int temp_doctors_target; // Alvo calculado pelo controlador no Admission
+    
+    // Profundidade da MSQ por prioridade, mantida no msgsnd/msgrcv
+    // (evita msgctl(IPC_STAT) para saber o tamanho da fila)
+    atomic_int queue_depth[NUM_PRIORITIES];
+    
+    // Grupos de Doctors: cada grupo tem uma lane por prioridade
+    // (lane = grupo * NUM_PRIORITIES + prioridade - 1, mtype = lane + 1)
+    int num_groups;
+    int group_low[MAX_DOCTOR_GROUPS];       // Prioridades atendidas pelo grupo
+    int group_high[MAX_DOCTOR_GROUPS];
+    int group_doctors[MAX_DOCTOR_GROUPS];   // Doctors permanentes do grupo
+    atomic_int lane_depth[NUM_QUEUE_LANES];
+    atomic_llong steals[MAX_DOCTOR_GROUPS]; // Pacientes roubados por Doctors do grupo
+    
+    // Utilização por thread de triagem e por Doctor (sem mutex: cada linha
+    // só é escrita pelo seu dono); a triagem do front-end N usa as linhas a
+    // partir de N * USAGE_TRIAGE_SLOTS e a última linha dos Doctors é a dos temporários
+    WorkerUsage triage_usage[(MAX_FRONTENDS + 1) * USAGE_TRIAGE_SLOTS];
+    WorkerUsage doctor_usage[USAGE_DOCTOR_SLOTS + 1];
+    
+    // Janelas de 1 s / 10 s / 60 s (sem mutex, ver rolling.c)
+    RollingStats rolling;
+    
+    // Configuração atual, publicada pelo Admission com o mutex a cada
+    // recarregamento; os Doctors copiam-na quando a versão muda (reload.c)
+    atomic_uint config_version;
+    Config config;
+    
+    // Modo scale-out (ver scaleout.c): o coordenador cria os Doctors e os
+    // front-ends só triam; o número de chegada é partilhado por todos
+    atomic_int coordinator_pid;             // 0 até o coordenador estar pronto
+    atomic_int frontend_pids[MAX_FRONTENDS];    // Front-end N na posição N - 1 (0 = livre)
+    atomic_long frontend_accepted;          // Aceites pelos front-ends que já saíram
+    atomic_int arrival_counter;             // Último número de chegada atribuído
+    
+    // Instante de entrada na MSQ (CLOCK_MONOTONIC, ns) de cada mensagem, por
+    // lane: a mensagem n ocupa enqueue_time_ns[lane][n % QUEUE_AGE_RING]
+    // e a mais antiga ainda em fila é a dequeue_seq[lane]
+    atomic_ullong enqueue_seq[NUM_QUEUE_LANES];
+    atomic_ullong dequeue_seq[NUM_QUEUE_LANES];
+    atomic_llong enqueue_time_ns[NUM_QUEUE_LANES][QUEUE_AGE_RING];
+    atomic_llong deadline_ns[NUM_QUEUE_LANES][QUEUE_AGE_RING];  // Prazo (CLOCK_REALTIME)
+    
+    // Estado da política WFQ por lane / grupo (ver policy.c)
+    atomic_llong wfq_pass[NUM_QUEUE_LANES];
+    atomic_llong wfq_vtime[MAX_DOCTOR_GROUPS];
+    
+    // Disciplina dentro de cada prioridade (QUEUE_DISCIPLINE_*, ver msq.h)
+    int queue_discipline;
+    long long sjf_max_wait_ns;      // Limite de espera antes de ignorar o SJF
+    DoctorQueue doctor_queue;       // Fila usada em vez da MSQ no modo SJF
 } Statistics;
 
 /* Ponteiro global para a memória partilhada */
@@ -32,13 +135,23 @@ extern int shm_fd;
 
 /* Funções para gestão da memória partilhada */
 int create_shared_memory();
+void set_shared_memory_numa_node(int node);
 int attach_shared_memory();
 void detach_shared_memory();
 void destroy_shared_memory();
 
 /* Funções para atualizar estatísticas */
 void update_triaged_stats(double wait_time);
-void update_attended_stats(double wait_time, double total_time);
+void update_attended_stats(int priority, double wait_time, double total_time, double lateness);
 void print_statistics();
+void get_stats_counters(int *triaged, int *attended);
+double get_latency_percentile(double fraction);
+
+/* Funções para a tabela de utilização (mark_ns: variável local do dono) */
+WorkerUsage* get_worker_usage(int kind, int id);
+void worker_usage_start(WorkerUsage *usage, long long *mark_ns);
+void worker_usage_add(WorkerUsage *usage, long long *mark_ns,
+                      const struct timespec *busy_start, const struct timespec *busy_end);
+void worker_usage_stop(WorkerUsage *usage, long long *mark_ns);
 
 #endif // SHM_H
\ No newline at end of file
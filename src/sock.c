@@ -0,0 +1,293 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ */
+
+#define _GNU_SOURCE // Para accept4
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include "sock.h"
+#include "log.h"
+#include "scaleout.h"
+
+#define DEBUG 
+
+/* Socket de escuta e instância epoll (o epoll fd é usado no select do main) */
+static int listen_fd = -1;
+static int epoll_fd = -1;
+static int num_clients = 0;
+static int client_fds[SOCKET_MAX_CLIENTS];
+
+/* Caminho do socket desta instância ("base.N" nos front-ends) */
+static char socket_path[INSTANCE_NAME_MAX] = SOCKET_NAME;
+
+/* Buffer de receção (uma mensagem SOCK_SEQPACKET de cada vez) */
+static char message_buffer[SOCKET_MAX_MESSAGE + 1];
+
+/*
+ * Caminho do socket de ingestão desta instância
+ */
+const char* get_ingest_socket_name() {
+    return socket_path;
+}
+
+/*
+ * Cria o socket Unix SOCK_SEQPACKET de ingestão e a instância epoll
+ * Retorna 0 em caso de sucesso, -1 em caso de erro
+ */
+int create_ingest_socket() {
+    instance_name(SOCKET_NAME, socket_path, sizeof(socket_path));
+    
+    #ifdef DEBUG
+    printf("[DEBUG] A criar socket de ingestão '%s'...\n", socket_path);
+    #endif
+    
+    // Remover socket anterior (se existir)
+    unlink(socket_path);
+    
+    listen_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd == -1) {
+        perror("Erro ao criar socket de ingestão (socket)");
+        return -1;
+    }
+    
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", socket_path) >= (int)sizeof(addr.sun_path)) {
+        fprintf(stderr, "ERRO: Caminho do socket demasiado longo: %s\n", socket_path);
+        close(listen_fd);
+        listen_fd = -1;
+        return -1;
+    }
+    
+    if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+        perror("Erro ao associar socket de ingestão (bind)");
+        close(listen_fd);
+        listen_fd = -1;
+        return -1;
+    }
+    
+    if (listen(listen_fd, SOMAXCONN) == -1) {
+        perror("Erro ao colocar socket em escuta (listen)");
+        close(listen_fd);
+        listen_fd = -1;
+        unlink(socket_path);
+        return -1;
+    }
+    
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd == -1) {
+        perror("Erro ao criar instância epoll");
+        close(listen_fd);
+        listen_fd = -1;
+        unlink(socket_path);
+        return -1;
+    }
+    
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.fd = listen_fd;
+    
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev) == -1) {
+        perror("Erro ao registar socket de escuta no epoll");
+        close(epoll_fd);
+        close(listen_fd);
+        epoll_fd = listen_fd = -1;
+        unlink(socket_path);
+        return -1;
+    }
+    
+    printf("Socket de ingestão criado: %s\n", socket_path);
+    
+    return 0;
+}
+
+/*
+ * Devolve o descritor a vigiar no select() do processo Admission
+ */
+int get_ingest_poll_fd() {
+    return epoll_fd;
+}
+
+/*
+ * Fecha a ligação de um cliente
+ */
+static void close_client(int fd) {
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+    close(fd);
+    
+    for (int i = 0; i < num_clients; i++) {
+        if (client_fds[i] == fd) {
+            client_fds[i] = client_fds[num_clients - 1];
+            break;
+        }
+    }
+    num_clients--;
+    
+    #ifdef DEBUG
+    printf("[DEBUG] Cliente do socket desligado (fd: %d, restantes: %d)\n", fd, num_clients);
+    #endif
+}
+
+/*
+ * Aceita todas as ligações pendentes
+ */
+static void accept_clients() {
+    while (1) {
+        int client_fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        
+        if (client_fd == -1) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                write_log("ERRO: Falha ao aceitar cliente no socket de ingestão");
+            }
+            return;
+        }
+        
+        if (num_clients >= SOCKET_MAX_CLIENTS) {
+            write_log("AVISO: Limite de %d clientes no socket atingido, ligação recusada", 
+                     SOCKET_MAX_CLIENTS);
+            close(client_fd);
+            continue;
+        }
+        
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.fd = client_fd;
+        
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, client_fd, &ev) == -1) {
+            write_log("ERRO: Falha ao registar cliente no epoll");
+            close(client_fd);
+            continue;
+        }
+        
+        client_fds[num_clients++] = client_fd;
+        
+        #ifdef DEBUG
+        printf("[DEBUG] Novo cliente no socket de ingestão (fd: %d, total: %d)\n", 
+               client_fd, num_clients);
+        #endif
+    }
+}
+
+/*
+ * Lê até SOCKET_MESSAGES_PER_ROUND mensagens de um cliente e responde a
+ * cada uma com "ACK <aceites> <descartados> <rejeitados>"
+ * Retorna -1 se a ligação deve ser fechada
+ */
+static int serve_client(int fd, IngestHandler handler) {
+    for (int i = 0; i < SOCKET_MESSAGES_PER_ROUND; i++) {
+        struct iovec iov = { message_buffer, SOCKET_MAX_MESSAGE };
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        
+        ssize_t len = recvmsg(fd, &msg, 0);
+        
+        if (len == 0) {
+            return -1; // Cliente fechou a ligação
+        }
+        if (len == -1) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                return 0;
+            }
+            return -1;
+        }
+        
+        IngestResult result = {0, 0, 0};
+        
+        if (msg.msg_flags & MSG_TRUNC) {
+            write_log("ERRO: Mensagem no socket excede %d bytes, rejeitada", SOCKET_MAX_MESSAGE);
+            result.rejected = 1;
+        } else {
+            message_buffer[len] = '\0';
+            handler(message_buffer, (size_t)len, &result);
+        }
+        
+        char ack[SOCKET_ACK_SIZE];
+        int ack_len = snprintf(ack, sizeof(ack), "ACK %d %d %d", 
+                               result.accepted, result.dropped, result.rejected);
+        
+        // Não bloquear o Admission: se o cliente não lê os ACKs, a ligação é fechada
+        if (send(fd, ack, ack_len, MSG_DONTWAIT | MSG_NOSIGNAL) == -1) {
+            write_log("AVISO: Cliente do socket não recebe ACKs (fd: %d), a desligar", fd);
+            return -1;
+        }
+    }
+    
+    return 0;
+}
+
+/*
+ * Trata os eventos pendentes no epoll (não-bloqueante)
+ */
+void process_ingest_events(IngestHandler handler) {
+    struct epoll_event events[64];
+    
+    int n = epoll_wait(epoll_fd, events, 64, 0);
+    if (n == -1) {
+        if (errno != EINTR) {
+            write_log("ERRO: Falha no epoll_wait do socket de ingestão");
+        }
+        return;
+    }
+    
+    for (int i = 0; i < n; i++) {
+        int fd = events[i].data.fd;
+        
+        if (fd == listen_fd) {
+            accept_clients();
+            continue;
+        }
+        
+        // Mensagens pendentes são lidas antes de tratar o fecho da ligação
+        int close_it = 0;
+        if (events[i].events & EPOLLIN) {
+            close_it = (serve_client(fd, handler) == -1);
+        } else if (events[i].events & (EPOLLHUP | EPOLLRDHUP | EPOLLERR)) {
+            close_it = 1;
+        }
+        
+        if (close_it) {
+            close_client(fd);
+        }
+    }
+}
+
+/*
+ * Fecha o socket de ingestão e todas as ligações
+ */
+void destroy_ingest_socket() {
+    #ifdef DEBUG
+    printf("[DEBUG] A destruir socket de ingestão...\n");
+    #endif
+    
+    if (epoll_fd != -1) {
+        close(epoll_fd);
+        epoll_fd = -1;
+    }
+    
+    for (int i = 0; i < num_clients; i++) {
+        close(client_fds[i]);
+    }
+    num_clients = 0;
+    
+    if (listen_fd != -1) {
+        close(listen_fd);
+        listen_fd = -1;
+    }
+    
+    if (unlink(socket_path) == -1 && errno != ENOENT) {
+        perror("Aviso: Erro ao remover socket de ingestão");
+    }
+}
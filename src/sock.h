@@ -0,0 +1,36 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ */
+
+#ifndef SOCK_H
+#define SOCK_H
+
+#include <stddef.h>
+
+#define SOCKET_NAME "/tmp/urgencias.sock"
+#define SOCKET_MAX_CLIENTS 256
+#define SOCKET_MAX_MESSAGE (256 * 1024)    // Tamanho máximo de uma mensagem
+#define SOCKET_MESSAGES_PER_ROUND 64       // Mensagens por cliente em cada ronda (justiça)
+#define SOCKET_ACK_SIZE 64
+
+/* Resultado do processamento de uma mensagem (devolvido ao cliente no ACK) */
+typedef struct {
+    int accepted;                // Pacientes admitidos (ou comandos aplicados)
+    int dropped;                 // Pacientes descartados (fila de triagem cheia)
+    int rejected;                // Linhas/registos inválidos
+} IngestResult;
+
+/* Função chamada para cada mensagem recebida */
+typedef void (*IngestHandler)(const char *message, size_t length, IngestResult *result);
+
+/* Funções para gestão do socket de ingestão */
+int create_ingest_socket();
+const char* get_ingest_socket_name();
+int get_ingest_poll_fd();
+void process_ingest_events(IngestHandler handler);
+void destroy_ingest_socket();
+
+#endif // SOCK_H
@@ -0,0 +1,155 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "timeline.h"
+#include "log.h"
+
+#define DEBUG
+
+/* Ficheiro de eventos mapeado (MAP_SHARED: os Doctors herdam-no no fork) */
+static TimelineFile *timeline = NULL;
+static size_t timeline_size = 0;
+static int timeline_fd = -1;
+
+/* PID/TID em cache por thread (repostos no filho depois de um fork) */
+static __thread int cached_pid = 0;
+static __thread int cached_tid = 0;
+static __thread int current_actor = 0;
+
+static void timeline_after_fork_child() {
+    cached_pid = 0;
+    cached_tid = 0;
+}
+
+/*
+ * Cria e mapeia o ficheiro de eventos com espaço para 'capacity' eventos
+ * Tem de ser chamado antes de criar as threads de triagem e os Doctors
+ * Retorna 0 em caso de sucesso, -1 em caso de erro
+ */
+int open_timeline(int capacity) {
+    timeline_size = sizeof(TimelineFile) + (size_t)capacity * sizeof(TimelineEvent);
+    
+    timeline_fd = open(TIMELINE_FILENAME, O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (timeline_fd == -1) {
+        perror("Erro ao criar ficheiro de eventos");
+        return -1;
+    }
+    
+    if (ftruncate(timeline_fd, timeline_size) == -1) {
+        perror("Erro ao definir tamanho do ficheiro de eventos");
+        close(timeline_fd);
+        timeline_fd = -1;
+        return -1;
+    }
+    
+    timeline = mmap(NULL, timeline_size, PROT_READ | PROT_WRITE, MAP_SHARED, timeline_fd, 0);
+    if (timeline == MAP_FAILED) {
+        perror("Erro ao mapear ficheiro de eventos");
+        close(timeline_fd);
+        timeline_fd = -1;
+        timeline = NULL;
+        return -1;
+    }
+    
+    timeline->magic = TIMELINE_MAGIC;
+    timeline->version = TIMELINE_VERSION;
+    timeline->record_size = sizeof(TimelineEvent);
+    timeline->capacity = capacity;
+    timeline->admission_pid = getpid();
+    atomic_store(&timeline->next, 0);
+    atomic_store(&timeline->dropped, 0);
+    
+    pthread_atfork(NULL, NULL, timeline_after_fork_child);
+    
+    #ifdef DEBUG
+    printf("[DEBUG] Linha temporal %s mapeada (%d eventos de %zu bytes)\n", TIMELINE_FILENAME,
+           capacity, sizeof(TimelineEvent));
+    #endif
+    
+    return 0;
+}
+
+int timeline_enabled() {
+    return timeline != NULL;
+}
+
+/*
+ * Identifica a thread/processo atual nos eventos seguintes
+ * (ID da thread de triagem, ou do Doctor com TEMP-N = -N)
+ */
+void timeline_set_actor(int actor) {
+    current_actor = actor;
+}
+
+/*
+ * Acrescenta um intervalo (sem locks: fetch_add reserva o evento)
+ */
+void timeline_record(int kind, int arrival_number, const struct timespec *start,
+                     const struct timespec *end) {
+    if (timeline == NULL) {
+        return;
+    }
+    
+    long index = atomic_fetch_add_explicit(&timeline->next, 1, memory_order_relaxed);
+    if (index >= timeline->capacity) {
+        atomic_fetch_add_explicit(&timeline->dropped, 1, memory_order_relaxed);
+        return;
+    }
+    
+    if (cached_pid == 0) {
+        cached_pid = getpid();
+        cached_tid = (int)syscall(SYS_gettid);
+    }
+    
+    TimelineEvent *event = &timeline->events[index];
+    event->kind = kind;
+    event->pid = cached_pid;
+    event->tid = cached_tid;
+    event->actor = current_actor;
+    event->arrival_number = arrival_number;
+    event->start_ns = (long long)start->tv_sec * 1000000000LL + start->tv_nsec;
+    event->end_ns = (long long)end->tv_sec * 1000000000LL + end->tv_nsec;
+    
+    atomic_store_explicit(&event->complete, 1, memory_order_release);
+}
+
+/*
+ * Desmapeia a linha temporal e corta o ficheiro aos eventos usados
+ * Chamado pelo Admission depois de terminar triagem e Doctors
+ */
+void close_timeline() {
+    if (timeline == NULL) {
+        return;
+    }
+    
+    long used = atomic_load(&timeline->next);
+    if (used > timeline->capacity) {
+        used = timeline->capacity;
+    }
+    long dropped = atomic_load(&timeline->dropped);
+    
+    msync(timeline, timeline_size, MS_SYNC);
+    munmap(timeline, timeline_size);
+    timeline = NULL;
+    
+    if (ftruncate(timeline_fd, sizeof(TimelineFile) + used * sizeof(TimelineEvent)) == -1) {
+        perror("Erro ao ajustar tamanho do ficheiro de eventos");
+    }
+    close(timeline_fd);
+    timeline_fd = -1;
+    
+    printf("Linha temporal: %ld eventos em %s (%ld sem espaço)\n", used, TIMELINE_FILENAME, dropped);
+    write_log("Linha temporal: %ld eventos em %s (%ld sem espaço)", used, TIMELINE_FILENAME, dropped);
+}
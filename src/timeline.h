@@ -0,0 +1,65 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ */
+
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include <stdatomic.h>
+#include <time.h>
+#include <sys/types.h>
+
+#define TIMELINE_FILENAME "urgencias.events"
+#define TIMELINE_MAGIC 0x55524745u          // "UGRE"
+#define TIMELINE_VERSION 1
+
+/* Tipos de intervalo */
+#define TL_TRIAGE       1   // Triagem de um paciente (thread de triagem)
+#define TL_ATTENDANCE   2   // Atendimento de um paciente (Doctor)
+#define TL_WAIT_TRIAGE  3   // Paciente na fila de triagem (chegada -> triagem)
+#define TL_WAIT_DOCTOR  4   // Paciente na fila de atendimento (triagem -> Doctor)
+#define TL_LOG_FLUSH    5   // msync do log em write_log
+#define TL_LOCK_LOG     6   // Espera pelo log_mutex (só quando estava ocupado)
+#define TL_LOCK_STATS   7   // Espera pelo mutex das estatísticas na SHM
+#define TL_LOCK_QUEUE   8   // Espera pelo mutex da fila de triagem
+#define TL_LOCK_CONTROL 9   // Espera pelo triage_control_mutex
+#define TL_NUM_KINDS    10
+
+/* Um intervalo [start_ns, end_ns] (CLOCK_REALTIME, como os instantes do Patient) */
+typedef struct {
+    atomic_int complete;            // 1 depois de o evento estar todo escrito
+    int kind;                       // TL_*
+    int pid;
+    int tid;
+    int actor;                      // Thread de triagem (1..) ou Doctor (TEMP-N = -N), 0 = outro
+    int arrival_number;             // Paciente (0 = nenhum)
+    long long start_ns;
+    long long end_ns;
+} TimelineEvent;
+
+/* Ficheiro mapeado: cabeçalho seguido de 'capacity' eventos */
+typedef struct {
+    unsigned int magic;
+    int version;
+    int record_size;                // sizeof(TimelineEvent)
+    int capacity;
+    int admission_pid;              // Para o conversor separar Admission e Doctors
+    atomic_long next;               // Próximo evento livre (pode passar capacity)
+    atomic_long dropped;            // Eventos perdidos (ficheiro cheio)
+    TimelineEvent events[];
+} TimelineFile;
+
+/* Funções para gestão da linha temporal (Admission) */
+int open_timeline(int capacity);
+void close_timeline();
+
+/* Funções usadas pela triagem, pelos Doctors e por lock_mutex (lockstat.c) */
+int timeline_enabled();
+void timeline_set_actor(int actor);
+void timeline_record(int kind, int arrival_number, const struct timespec *start,
+                     const struct timespec *end);
+
+#endif // TIMELINE_H
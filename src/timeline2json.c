@@ -0,0 +1,238 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ *
+ * Conversor da linha temporal (urgencias.events) para o formato JSON de
+ * eventos do Chrome (chrome://tracing, Perfetto): um processo por Admission
+ * e Doctor, uma linha por thread, esperas nas filas como eventos assíncronos
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "timeline.h"
+
+#define MAX_ACTORS 1024
+
+static const char *kind_names[TL_NUM_KINDS] = {
+    NULL, "triagem", "atendimento", "espera triagem", "espera Doctor",
+    "msync log", "espera log_mutex", "espera mutex estatísticas",
+    "espera mutex fila triagem", "espera triage_control_mutex"
+};
+
+static const char *kind_categories[TL_NUM_KINDS] = {
+    NULL, "paciente", "paciente", "fila_triagem", "fila_atendimento",
+    "log", "lock", "lock", "lock", "lock"
+};
+
+/* Processo ou thread já vistos (para os metadados de nome) */
+typedef struct {
+    int pid;
+    int tid;
+    int actor;
+} Actor;
+
+/*
+ * Lê o ficheiro inteiro
+ * Retorna o cabeçalho (alocado) ou NULL em caso de erro; *count = eventos válidos
+ */
+static TimelineFile* load_timeline_file(const char *filename, long *count) {
+    FILE *file = fopen(filename, "rb");
+    if (file == NULL) {
+        perror("Erro ao abrir ficheiro da linha temporal");
+        return NULL;
+    }
+    
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    
+    if (size < (long)sizeof(TimelineFile)) {
+        fprintf(stderr, "ERRO: %s não é um ficheiro de linha temporal\n", filename);
+        fclose(file);
+        return NULL;
+    }
+    
+    TimelineFile *timeline = malloc(size);
+    if (timeline == NULL || fread(timeline, 1, size, file) != (size_t)size) {
+        perror("Erro ao ler ficheiro da linha temporal");
+        free(timeline);
+        fclose(file);
+        return NULL;
+    }
+    fclose(file);
+    
+    if (timeline->magic != TIMELINE_MAGIC || timeline->version != TIMELINE_VERSION ||
+        timeline->record_size != (int)sizeof(TimelineEvent)) {
+        fprintf(stderr, "ERRO: %s é de outra versão da linha temporal\n", filename);
+        free(timeline);
+        return NULL;
+    }
+    
+    // Como no rasto: se foi lido a meio, conta só o que já está no ficheiro
+    long used = atomic_load(&timeline->next);
+    long in_file = (size - (long)sizeof(TimelineFile)) / (long)sizeof(TimelineEvent);
+    if (used > timeline->capacity) {
+        used = timeline->capacity;
+    }
+    *count = (used < in_file) ? used : in_file;
+    
+    return timeline;
+}
+
+static int valid_event(const TimelineEvent *event) {
+    return atomic_load(&event->complete) && event->kind > 0 && event->kind < TL_NUM_KINDS;
+}
+
+/*
+ * Regista o par (pid, tid) com o seu ator; tid = 0 regista o processo
+ * O primeiro ator diferente de 0 ganha (os primeiros eventos de um Doctor
+ * podem ser anteriores a timeline_set_actor)
+ */
+static void remember_actor(Actor *actors, int *count, int pid, int tid, int actor) {
+    for (int i = 0; i < *count; i++) {
+        if (actors[i].pid == pid && actors[i].tid == tid) {
+            if (actors[i].actor == 0) {
+                actors[i].actor = actor;
+            }
+            return;
+        }
+    }
+    if (*count < MAX_ACTORS) {
+        actors[*count].pid = pid;
+        actors[*count].tid = tid;
+        actors[*count].actor = actor;
+        (*count)++;
+    }
+}
+
+static void print_separator(int *first) {
+    printf("%s\n", *first ? "" : ",");
+    *first = 0;
+}
+
+/*
+ * Metadados: nome de cada processo e das threads de triagem do Admission
+ */
+static void print_metadata(const TimelineFile *timeline, const Actor *actors, int count, int *first) {
+    for (int i = 0; i < count; i++) {
+        const Actor *a = &actors[i];
+        char name[32];
+        
+        if (a->tid == 0) {
+            if (a->pid == timeline->admission_pid) {
+                snprintf(name, sizeof(name), "Admission");
+            } else if (a->actor < 0) {
+                snprintf(name, sizeof(name), "Doctor TEMP-%d", -a->actor);
+            } else if (a->actor > 0) {
+                snprintf(name, sizeof(name), "Doctor %d", a->actor);
+            } else {
+                snprintf(name, sizeof(name), "Processo %d", a->pid);
+            }
+            print_separator(first);
+            printf("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"%s\"}}",
+                   a->pid, name);
+        } else if (a->pid == timeline->admission_pid) {
+            if (a->actor > 0) {
+                snprintf(name, sizeof(name), "Triagem %d", a->actor);
+            } else {
+                snprintf(name, sizeof(name), "Admission %d", a->tid);
+            }
+            print_separator(first);
+            printf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                   a->pid, a->tid, name);
+        }
+    }
+}
+
+static void print_events(const TimelineFile *timeline, long count) {
+    Actor *actors = malloc(MAX_ACTORS * sizeof(Actor));
+    int actor_count = 0;
+    if (actors == NULL) {
+        perror("Erro ao alocar memória");
+        return;
+    }
+    
+    // Origem dos tempos: o início mais antigo
+    long long origin = 0;
+    int have_origin = 0;
+    for (long i = 0; i < count; i++) {
+        const TimelineEvent *event = &timeline->events[i];
+        if (valid_event(event) && (!have_origin || event->start_ns < origin)) {
+            origin = event->start_ns;
+            have_origin = 1;
+        }
+    }
+    
+    int first = 1;
+    printf("{\"traceEvents\":[");
+    
+    for (long i = 0; i < count; i++) {
+        const TimelineEvent *event = &timeline->events[i];
+        if (!valid_event(event)) {
+            continue;
+        }
+            
+        remember_actor(actors, &actor_count, event->pid, 0, event->actor);
+        remember_actor(actors, &actor_count, event->pid, event->tid, event->actor);
+            
+        double ts = (event->start_ns - origin) / 1e3;
+        double end = (event->end_ns - origin) / 1e3;
+        const char *name = kind_names[event->kind];
+        const char *category = kind_categories[event->kind];
+            
+        if (event->kind == TL_WAIT_TRIAGE || event->kind == TL_WAIT_DOCTOR) {
+            // Espera na fila: par assíncrono com id = número de chegada
+            print_separator(&first);
+            printf("{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"b\",\"id\":%d,\"pid\":%d,\"tid\":%d,"
+                   "\"ts\":%.3f,\"args\":{\"paciente\":%d}}",
+                   name, category, event->arrival_number, event->pid, event->tid, ts,
+                   event->arrival_number);
+            print_separator(&first);
+            printf("{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"e\",\"id\":%d,\"pid\":%d,\"tid\":%d,"
+                   "\"ts\":%.3f}",
+                   name, category, event->arrival_number, event->pid, event->tid, end);
+        } else {
+            print_separator(&first);
+            printf("{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,"
+                   "\"ts\":%.3f,\"dur\":%.3f",
+                   name, category, event->pid, event->tid, ts, end - ts);
+            if (event->arrival_number > 0) {
+                printf(",\"args\":{\"paciente\":%d}", event->arrival_number);
+            }
+            printf("}");
+        }
+    }
+    
+    print_metadata(timeline, actors, actor_count, &first);
+    printf("\n],\"displayTimeUnit\":\"ms\"}\n");
+    
+    free(actors);
+}
+
+int main(int argc, char *argv[]) {
+    const char *filename = TIMELINE_FILENAME;
+    
+    for (int i = 1; i < argc; i++) {
+        if (argv[i][0] == '-') {
+            fprintf(stderr, "Uso: %s [ficheiro (omissão: %s)] > linha.json\n", argv[0], TIMELINE_FILENAME);
+            return EXIT_FAILURE;
+        }
+        filename = argv[i];
+    }
+    
+    long count;
+    TimelineFile *timeline = load_timeline_file(filename, &count);
+    if (timeline == NULL) {
+        return EXIT_FAILURE;
+    }
+    
+    print_events(timeline, count);
+    fprintf(stderr, "Linha temporal: %ld eventos (sem espaço: %ld)\n",
+            count, atomic_load(&timeline->dropped));
+    
+    free(timeline);
+    return EXIT_SUCCESS;
+}
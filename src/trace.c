@@ -0,0 +1,139 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include "trace.h"
+#include "log.h"
+
+#define DEBUG
+
+/* Ficheiro de rasto mapeado (MAP_SHARED: os Doctors herdam-no no fork) */
+static TraceFile *trace = NULL;
+static size_t trace_size = 0;
+static int trace_fd = -1;
+
+static long long timespec_ns(const struct timespec *ts) {
+    return (long long)ts->tv_sec * 1000000000LL + ts->tv_nsec;
+}
+
+/*
+ * Cria e mapeia o ficheiro de rasto com espaço para 'capacity' pacientes
+ * Tem de ser chamado antes de criar os Doctors
+ * Retorna 0 em caso de sucesso, -1 em caso de erro
+ */
+int open_trace(int capacity) {
+    trace_size = sizeof(TraceFile) + (size_t)capacity * sizeof(TraceRecord);
+    
+    trace_fd = open(TRACE_FILENAME, O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (trace_fd == -1) {
+        perror("Erro ao criar ficheiro de rasto");
+        return -1;
+    }
+    
+    // Ficheiro esparso: só as páginas escritas ocupam disco
+    if (ftruncate(trace_fd, trace_size) == -1) {
+        perror("Erro ao definir tamanho do ficheiro de rasto");
+        close(trace_fd);
+        trace_fd = -1;
+        return -1;
+    }
+    
+    trace = mmap(NULL, trace_size, PROT_READ | PROT_WRITE, MAP_SHARED, trace_fd, 0);
+    if (trace == MAP_FAILED) {
+        perror("Erro ao mapear ficheiro de rasto");
+        close(trace_fd);
+        trace_fd = -1;
+        trace = NULL;
+        return -1;
+    }
+    
+    trace->magic = TRACE_MAGIC;
+    trace->version = TRACE_VERSION;
+    trace->record_size = sizeof(TraceRecord);
+    trace->capacity = capacity;
+    atomic_store(&trace->next, 0);
+    atomic_store(&trace->dropped, 0);
+    
+    #ifdef DEBUG
+    printf("[DEBUG] Rasto %s mapeado (%d registos de %zu bytes)\n", TRACE_FILENAME, capacity,
+           sizeof(TraceRecord));
+    #endif
+    
+    return 0;
+}
+
+/*
+ * Acrescenta um paciente atendido ao rasto (sem locks: cada Doctor reserva
+ * um registo com um fetch_add e marca-o completo no fim)
+ */
+void trace_patient(const Patient *patient, int doctor_id, int group,
+                   const struct timespec *attendance_start, const struct timespec *attendance_end) {
+    if (trace == NULL) {
+        return;
+    }
+    
+    long index = atomic_fetch_add_explicit(&trace->next, 1, memory_order_relaxed);
+    if (index >= trace->capacity) {
+        atomic_fetch_add_explicit(&trace->dropped, 1, memory_order_relaxed);
+        return;
+    }
+    
+    TraceRecord *record = &trace->records[index];
+    record->arrival_number = patient->arrival_number;
+    memcpy(record->name, patient->name, sizeof(record->name));
+    record->priority = patient->priority;
+    record->triage_time = patient->triage_time;
+    record->attendance_time = patient->attendance_time;
+    record->triage_thread = patient->triage_thread;
+    record->doctor_id = doctor_id;
+    record->doctor_pid = getpid();
+    record->group = group;
+    record->triage_queue_depth = patient->triage_queue_depth;
+    record->queue_depth = patient->queue_depth;
+    record->arrival_ns = timespec_ns(&patient->arrival_time);
+    record->triage_start_ns = timespec_ns(&patient->triage_start);
+    record->triage_end_ns = timespec_ns(&patient->triage_end);
+    record->attendance_start_ns = timespec_ns(attendance_start);
+    record->attendance_end_ns = timespec_ns(attendance_end);
+    record->deadline_ns = timespec_ns(&patient->deadline);
+    
+    atomic_store_explicit(&record->complete, 1, memory_order_release);
+}
+
+/*
+ * Desmapeia o rasto e corta o ficheiro aos registos usados
+ * Chamado pelo Admission depois de terminar os Doctors
+ */
+void close_trace() {
+    if (trace == NULL) {
+        return;
+    }
+    
+    long used = atomic_load(&trace->next);
+    if (used > trace->capacity) {
+        used = trace->capacity;
+    }
+    long dropped = atomic_load(&trace->dropped);
+    
+    msync(trace, trace_size, MS_SYNC);
+    munmap(trace, trace_size);
+    trace = NULL;
+    
+    if (ftruncate(trace_fd, sizeof(TraceFile) + used * sizeof(TraceRecord)) == -1) {
+        perror("Erro ao ajustar tamanho do ficheiro de rasto");
+    }
+    close(trace_fd);
+    trace_fd = -1;
+    
+    printf("Rasto por paciente: %ld registos em %s (%ld sem espaço)\n", used, TRACE_FILENAME, dropped);
+    write_log("Rasto por paciente: %ld registos em %s (%ld sem espaço)", used, TRACE_FILENAME, dropped);
+}
@@ -0,0 +1,60 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdatomic.h>
+#include <time.h>
+#include "patient.h"
+
+#define TRACE_FILENAME "urgencias.trace"
+#define TRACE_MAGIC 0x55524754u             // "URGT"
+#define TRACE_VERSION 1
+
+/* Um paciente atendido, de tamanho fixo (instantes em CLOCK_REALTIME, ns) */
+typedef struct {
+    atomic_int complete;            // 1 depois de o registo estar todo escrito
+    int arrival_number;
+    char name[MAX_NAME_LENGTH];
+    int priority;
+    int triage_time;                // Tempos pedidos (ms)
+    int attendance_time;
+    int triage_thread;              // Thread de triagem (1..)
+    int doctor_id;                  // Doctor (temporários: -N = TEMP-N)
+    int doctor_pid;
+    int group;                      // Grupo do Doctor (0..)
+    int triage_queue_depth;         // Pacientes na fila de triagem à chegada
+    int queue_depth;                // Pacientes na fila de atendimento ao entrar
+    long long arrival_ns;
+    long long triage_start_ns;
+    long long triage_end_ns;
+    long long attendance_start_ns;
+    long long attendance_end_ns;
+    long long deadline_ns;
+} TraceRecord;
+
+/* Ficheiro mapeado: cabeçalho seguido de 'capacity' registos */
+typedef struct {
+    unsigned int magic;
+    int version;
+    int record_size;                // sizeof(TraceRecord), para o leitor validar
+    int capacity;
+    atomic_long next;               // Próximo registo livre (pode passar capacity)
+    atomic_long dropped;            // Pacientes não registados (ficheiro cheio)
+    TraceRecord records[];
+} TraceFile;
+
+/* Funções para gestão do rasto (Admission) */
+int open_trace(int capacity);
+void close_trace();
+
+/* Registo de um paciente atendido (Doctors) */
+void trace_patient(const Patient *patient, int doctor_id, int group,
+                   const struct timespec *attendance_start, const struct timespec *attendance_end);
+
+#endif // TRACE_H
@@ -0,0 +1,196 @@
+/*
+ * Sistemas Operativos 2025/2026
+ * Projeto: Urgências@DEI
+ * 
+ * Aluno : Diogo Marques de Lemos - 2020219666
+ *
+ * Leitor do rasto por paciente (urgencias.trace): um paciente por linha em
+ * CSV com a duração de cada etapa, ou (-s) um resumo por etapa
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "trace.h"
+
+#define NUM_STAGES 5
+
+static const char *stage_names[NUM_STAGES] = {
+    "espera triagem", "triagem", "espera Doctor", "atendimento", "total"
+};
+
+/*
+ * Duração de cada etapa de um paciente, em ms
+ */
+static void record_stages(const TraceRecord *record, double stages[NUM_STAGES]) {
+    stages[0] = (record->triage_start_ns - record->arrival_ns) / 1e6;
+    stages[1] = (record->triage_end_ns - record->triage_start_ns) / 1e6;
+    stages[2] = (record->attendance_start_ns - record->triage_end_ns) / 1e6;
+    stages[3] = (record->attendance_end_ns - record->attendance_start_ns) / 1e6;
+    stages[4] = (record->attendance_end_ns - record->arrival_ns) / 1e6;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/*
+ * Lê o ficheiro inteiro
+ * Retorna o cabeçalho (alocado) ou NULL em caso de erro; *count = registos válidos
+ */
+static TraceFile* load_trace_file(const char *filename, long *count) {
+    FILE *file = fopen(filename, "rb");
+    if (file == NULL) {
+        perror("Erro ao abrir ficheiro de rasto");
+        return NULL;
+    }
+    
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    
+    if (size < (long)sizeof(TraceFile)) {
+        fprintf(stderr, "ERRO: %s não é um ficheiro de rasto\n", filename);
+        fclose(file);
+        return NULL;
+    }
+    
+    TraceFile *trace = malloc(size);
+    if (trace == NULL || fread(trace, 1, size, file) != (size_t)size) {
+        perror("Erro ao ler ficheiro de rasto");
+        free(trace);
+        fclose(file);
+        return NULL;
+    }
+    fclose(file);
+    
+    if (trace->magic != TRACE_MAGIC || trace->version != TRACE_VERSION ||
+        trace->record_size != (int)sizeof(TraceRecord)) {
+        fprintf(stderr, "ERRO: %s é de outra versão do rasto\n", filename);
+        free(trace);
+        return NULL;
+    }
+    
+    // O ficheiro é cortado aos registos usados quando o Admission termina;
+    // se foi lido a meio, conta só o que já está no ficheiro
+    long used = atomic_load(&trace->next);
+    long in_file = (size - (long)sizeof(TraceFile)) / (long)sizeof(TraceRecord);
+    if (used > trace->capacity) {
+        used = trace->capacity;
+    }
+    *count = (used < in_file) ? used : in_file;
+    
+    return trace;
+}
+
+static void print_csv(const TraceFile *trace, long count) {
+    printf("arrival_number,name,priority,triage_thread,doctor,doctor_pid,group,"
+           "triage_queue_depth,queue_depth,wait_triage_ms,triage_ms,wait_doctor_ms,"
+           "attendance_ms,total_ms,sla_lateness_ms\n");
+    
+    for (long i = 0; i < count; i++) {
+        const TraceRecord *record = &trace->records[i];
+        if (!atomic_load(&record->complete)) {
+            continue;
+        }
+        
+        double stages[NUM_STAGES];
+        record_stages(record, stages);
+        
+        char doctor[24];
+        if (record->doctor_id < 0) {
+            snprintf(doctor, sizeof(doctor), "TEMP-%d", -record->doctor_id);
+        } else {
+            snprintf(doctor, sizeof(doctor), "%d", record->doctor_id);
+        }
+        
+        printf("%d,%.*s,%d,%d,%s,%d,%d,%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n",
+               record->arrival_number, MAX_NAME_LENGTH, record->name, record->priority,
+               record->triage_thread, doctor, record->doctor_pid, record->group + 1,
+               record->triage_queue_depth, record->queue_depth,
+               stages[0], stages[1], stages[2], stages[3], stages[4],
+               (record->attendance_start_ns - record->deadline_ns) / 1e6);
+    }
+}
+
+/*
+ * Resumo: média, p50, p99 e máximo de cada etapa e a fração do tempo
+ * total passada em cada uma (onde está o caminho crítico)
+ */
+static int print_summary(const TraceFile *trace, long count) {
+    double *values[NUM_STAGES];
+    for (int s = 0; s < NUM_STAGES; s++) {
+        values[s] = malloc((count > 0 ? count : 1) * sizeof(double));
+        if (values[s] == NULL) {
+            perror("Erro ao alocar memória");
+            return -1;
+        }
+    }
+    
+    long n = 0;
+    double sums[NUM_STAGES] = {0};
+    for (long i = 0; i < count; i++) {
+        if (!atomic_load(&trace->records[i].complete)) {
+            continue;
+        }
+        
+        double stages[NUM_STAGES];
+        record_stages(&trace->records[i], stages);
+        for (int s = 0; s < NUM_STAGES; s++) {
+            values[s][n] = stages[s];
+            sums[s] += stages[s];
+        }
+        n++;
+    }
+    
+    printf("Pacientes no rasto: %ld (sem espaço: %ld)\n", n, atomic_load(&trace->dropped));
+    
+    if (n > 0) {
+        printf("%-16s %10s %10s %10s %10s %8s\n", "etapa (ms)", "média", "p50", "p99", "máx", "% total");
+        for (int s = 0; s < NUM_STAGES; s++) {
+            qsort(values[s], n, sizeof(double), compare_doubles);
+            printf("%-16s %10.3f %10.3f %10.3f %10.3f %7.1f%%\n", stage_names[s], sums[s] / n,
+                   values[s][(n - 1) / 2], values[s][(long)((n - 1) * 0.99)], values[s][n - 1],
+                   (sums[4] > 0) ? 100.0 * sums[s] / sums[4] : 0.0);
+        }
+    }
+    
+    for (int s = 0; s < NUM_STAGES; s++) {
+        free(values[s]);
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    int summary = 0;
+    const char *filename = TRACE_FILENAME;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-s") == 0) {
+            summary = 1;
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "Uso: %s [-s] [ficheiro (omissão: %s)]\n", argv[0], TRACE_FILENAME);
+            return EXIT_FAILURE;
+        } else {
+            filename = argv[i];
+        }
+    }
+    
+    long count;
+    TraceFile *trace = load_trace_file(filename, &count);
+    if (trace == NULL) {
+        return EXIT_FAILURE;
+    }
+    
+    int result = 0;
+    if (summary) {
+        result = print_summary(trace, count);
+    } else {
+        print_csv(trace, count);
+    }
+    
+    free(trace);
+    return (result == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -16,7 +16,12 @@
 #include "msq.h"
 #include "patient.h"
 #include "log.h"
+#include "affinity.h"
+#include "timeline.h"
+#include "lockstat.h"
+#include "scaleout.h"
 #include <pthread.h>
+#include <signal.h>
 
 #define DEBUG 
 
@@ -26,11 +31,41 @@ TriageThreadInfo *triage_threads = NULL;
 int num_triage_threads = 0;
 volatile int triage_system_running = 1;
 
-/* Mutex para controlar alterações no número de threads */
+/* Mutex para controlar alterações no número de threads (resize e reaper) */
 pthread_mutex_t triage_control_mutex = PTHREAD_MUTEX_INITIALIZER;
 
-/* Configuração global (necessária para as threads) */
-static const Config *global_triage_config = NULL;
+/* Reaper: recolhe (pthread_join) as threads retiradas, fora do loop principal */
+static pthread_t reaper_thread;
+static int reaper_running = 0;
+static int reaper_pending = 0;
+static pthread_mutex_t reaper_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t reaper_cond = PTHREAD_COND_INITIALIZER;
+
+/* Prazos de SLA por prioridade, lidos pelas threads (atómicos: mudam ao recarregar) */
+static atomic_int triage_sla_ms[NUM_PRIORITIES];
+
+/* CPUs pelas quais as threads de triagem são distribuídas (TRIAGE_CPUS) */
+static CpuList triage_cpu_list;
+
+/* Thread do autoscaler */
+static pthread_t autoscaler_thread;
+static volatile int autoscaler_running = 0;
+static Config autoscaler_config;   // Cópia própria, feita antes de a thread arrancar
+
+/*
+ * Bloqueia nas threads auxiliares os sinais tratados pelo Admission, para
+ * que sejam sempre entregues à thread principal (os handlers escrevem no
+ * log e uma thread interrompida com o log_mutex adquirido ficava bloqueada)
+ */
+static void block_thread_signals() {
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGINT);
+    sigaddset(&set, SIGUSR1);
+    sigaddset(&set, SIGCHLD);
+    sigaddset(&set, SIGHUP);
+    pthread_sigmask(SIG_BLOCK, &set, NULL);
+}
 
 /*
  * Cria a fila de triagem
@@ -57,6 +92,8 @@ TriageQueue* create_triage_queue(int capacity) {
     queue->rear = -1;
     queue->count = 0;
     queue->capacity = capacity;
+    queue->total_enqueued = 0;
+    atomic_init(&queue->total_processed, 0);
     
     // Inicializar mutex e variáveis de condição
     if (pthread_mutex_init(&queue->mutex, NULL) != 0) {
@@ -105,7 +142,7 @@ int enqueue_patient(TriageQueue *queue, Patient *patient) {
     clock_gettime(CLOCK_REALTIME, &timeout);
     timeout.tv_sec += 5; // 5 segundos de timeout
     
-    int lock_result = pthread_mutex_lock(&queue->mutex);
+    int lock_result = lock_mutex(&queue->mutex, LOCK_TRIAGE_QUEUE);
     if (lock_result != 0) {
         fprintf(stderr, "ERRO: Falha ao obter mutex (erro %d)\n", lock_result);
         return -1;
@@ -121,9 +158,11 @@ int enqueue_patient(TriageQueue *queue, Patient *patient) {
     }
     
     // Adicionar paciente à fila
+    patient->triage_queue_depth = queue->count;
     queue->rear = (queue->rear + 1) % queue->capacity;
     queue->patients[queue->rear] = patient;
     queue->count++;
+    queue->total_enqueued++;
     
     #ifdef DEBUG
     printf("[DEBUG] Paciente %s adicionado à fila de triagem (posição %d/%d)\n",
@@ -140,24 +179,78 @@ int enqueue_patient(TriageQueue *queue, Patient *patient) {
     return 0;
 }
 
+/*
+ * Adiciona vários pacientes à fila de triagem com uma única aquisição do mutex
+ * Entram os primeiros que couberem; os restantes ficam a cargo de quem chama
+ * Retorna o número de pacientes adicionados, ou -1 em caso de erro
+ */
+int enqueue_patients(TriageQueue *queue, Patient **patients, int count) {
+    if (queue == NULL || patients == NULL || count < 0) {
+        fprintf(stderr, "ERRO: Fila ou pacientes NULL\n");
+        return -1;
+    }
+    
+    int lock_result = lock_mutex(&queue->mutex, LOCK_TRIAGE_QUEUE);
+    if (lock_result != 0) {
+        fprintf(stderr, "ERRO: Falha ao obter mutex (erro %d)\n", lock_result);
+        return -1;
+    }
+    
+    int space = queue->capacity - queue->count;
+    int added = (count < space) ? count : space;
+    
+    for (int i = 0; i < added; i++) {
+        patients[i]->triage_queue_depth = queue->count + i;
+        queue->rear = (queue->rear + 1) % queue->capacity;
+        queue->patients[queue->rear] = patients[i];
+    }
+    queue->count += added;
+    queue->total_enqueued += added;
+    
+    #ifdef DEBUG
+    printf("[DEBUG] %d/%d pacientes adicionados à fila de triagem (posição %d/%d)\n",
+           added, count, queue->count, queue->capacity);
+    #endif
+    
+    // Acordar tantas threads quantos os pacientes novos
+    if (added == 1) {
+        pthread_cond_signal(&queue->not_empty);
+    } else if (added > 1) {
+        pthread_cond_broadcast(&queue->not_empty);
+    }
+    
+    pthread_mutex_unlock(&queue->mutex);
+    
+    return added;
+}
+
 /*
  * Remove e retorna um paciente da fila de triagem
  * Bloqueia se a fila estiver vazia
  */
 Patient* dequeue_patient(TriageQueue *queue) {
+    return dequeue_patient_active(queue, NULL);
+}
+
+/*
+ * Como dequeue_patient(), mas retorna NULL assim que *state deixa de ser
+ * TRIAGE_THREAD_RUNNING (para as threads poderem ser retiradas da pool)
+ */
+Patient* dequeue_patient_active(TriageQueue *queue, atomic_int *state) {
     if (queue == NULL) {
         fprintf(stderr, "ERRO: Fila NULL\n");
         return NULL;
     }
     
-    int lock_result = pthread_mutex_lock(&queue->mutex);
+    int lock_result = lock_mutex(&queue->mutex, LOCK_TRIAGE_QUEUE);
     if (lock_result != 0) {
         fprintf(stderr, "ERRO: Falha ao obter mutex (erro %d)\n", lock_result);
         return NULL;
     }
     
     // Aguardar enquanto a fila está vazia e o sistema está a correr
-    while (queue->count == 0 && triage_system_running) {
+    while (queue->count == 0 && triage_system_running && 
+           (state == NULL || atomic_load_explicit(state, memory_order_relaxed) == TRIAGE_THREAD_RUNNING)) {
         int wait_result = pthread_cond_wait(&queue->not_empty, &queue->mutex);
         if (wait_result != 0) {
             write_log("ERRO: Falha em pthread_cond_wait (erro %d)", wait_result);
@@ -172,6 +265,13 @@ Patient* dequeue_patient(TriageQueue *queue) {
         return NULL;
     }
     
+    // Thread retirada da pool: deixar o paciente para as restantes
+    if (state != NULL && 
+        atomic_load_explicit(state, memory_order_relaxed) != TRIAGE_THREAD_RUNNING) {
+        pthread_mutex_unlock(&queue->mutex);
+        return NULL;
+    }
+    
     // Remover paciente da fila
     Patient *patient = queue->patients[queue->front];
     queue->front = (queue->front + 1) % queue->capacity;
@@ -192,6 +292,49 @@ Patient* dequeue_patient(TriageQueue *queue) {
     return patient;
 }
 
+/*
+ * Pacientes aceites na triagem que ainda não chegaram à fila de atendimento
+ * (em fila ou a ser triados por uma thread)
+ */
+int get_triage_pending(TriageQueue *queue) {
+    lock_mutex(&queue->mutex, LOCK_TRIAGE_QUEUE);
+    long enqueued = queue->total_enqueued;
+    pthread_mutex_unlock(&queue->mutex);
+    
+    return (int)(enqueued - atomic_load(&queue->total_processed));
+}
+
+/*
+ * Copia os pacientes em fila (do mais antigo para o mais recente) para 'out'
+ * e o total de aceites para *accepted, com o mutex da fila (checkpoint)
+ * Os que não couberem em 'max' são contados em *omitted
+ * Retorna o número de pacientes copiados
+ */
+int snapshot_triage_queue(TriageQueue *queue, Patient *out, int max, long *accepted, int *omitted) {
+    lock_mutex(&queue->mutex, LOCK_TRIAGE_QUEUE);
+    
+    int count = (queue->count < max) ? queue->count : max;
+    *omitted = queue->count - count;
+    for (int i = 0; i < count; i++) {
+        memcpy(&out[i], queue->patients[(queue->front + i) % queue->capacity], sizeof(Patient));
+    }
+    *accepted = queue->total_enqueued;
+    
+    pthread_mutex_unlock(&queue->mutex);
+    return count;
+}
+
+/*
+ * Define o total de pacientes aceites, todos já processados (recuperação
+ * de um checkpoint, antes de voltar a colocar os pacientes em fila)
+ */
+void set_triage_accepted(TriageQueue *queue, long accepted) {
+    lock_mutex(&queue->mutex, LOCK_TRIAGE_QUEUE);
+    queue->total_enqueued = accepted;
+    atomic_store(&queue->total_processed, accepted);
+    pthread_mutex_unlock(&queue->mutex);
+}
+
 /*
  * Destrói a fila de triagem
  */
@@ -204,7 +347,7 @@ void destroy_triage_queue(TriageQueue *queue) {
     printf("[DEBUG] A destruir fila de triagem...\n");
     #endif
     
-    pthread_mutex_lock(&queue->mutex);
+    lock_mutex(&queue->mutex, LOCK_TRIAGE_QUEUE);
     
     // Libertar pacientes restantes na fila
     if (queue->count > 0) {
@@ -240,36 +383,35 @@ void* triage_thread_function(void *arg) {
     int thread_id = *((int *)arg);
     free(arg);
     
+    TriageThreadInfo *self = &triage_threads[thread_id - 1];
+    // Cada instância (coordenador, front-ends) tem as suas linhas de utilização
+    WorkerUsage *usage = get_worker_usage(USAGE_TRIAGE, frontend_id * USAGE_TRIAGE_SLOTS + thread_id);
+    long long usage_mark;
+    
+    block_thread_signals();
+    worker_usage_start(usage, &usage_mark);
+    
+    timeline_set_actor(thread_id);
     write_log("Thread de triagem %d iniciada (TID: %lu)", thread_id, pthread_self());
     
     while (triage_system_running) {
         // Verificar se esta thread deve terminar (por redução dinâmica)
-        pthread_mutex_lock(&triage_control_mutex);
-        int should_terminate = 0;
-        if (thread_id > num_triage_threads) {
-            should_terminate = 1;
-        }
-        // Verificar também através do array
-        if (thread_id <= num_triage_threads && 
-            triage_threads != NULL && 
-            triage_threads[thread_id - 1].active == 0) {
-            should_terminate = 1;
-        }
-        pthread_mutex_unlock(&triage_control_mutex);
-        
-        if (should_terminate) {
+        if (atomic_load_explicit(&self->state, memory_order_relaxed) != TRIAGE_THREAD_RUNNING) {
             write_log("Thread de triagem %d a terminar (redução dinâmica)", thread_id);
             break;
         }
         
         // Obter paciente da fila
-        Patient *patient = dequeue_patient(triage_queue);
+        Patient *patient = dequeue_patient_active(triage_queue, &self->state);
         
         if (patient == NULL) {
-            // Sistema está a terminar
+            // Sistema está a terminar (ou thread retirada da pool)
             break;
         }
         
+        struct timespec busy_start, busy_end;
+        clock_gettime(CLOCK_MONOTONIC, &busy_start);
+        
         // Registar início da triagem
         clock_gettime(CLOCK_REALTIME, &patient->triage_start);
         
@@ -278,6 +420,17 @@ void* triage_thread_function(void *arg) {
         // Registar fim da triagem
         clock_gettime(CLOCK_REALTIME, &patient->triage_end);
         
+        timeline_record(TL_WAIT_TRIAGE, patient->arrival_number, &patient->arrival_time,
+                        &patient->triage_start);
+        timeline_record(TL_TRIAGE, patient->arrival_number, &patient->triage_start,
+                        &patient->triage_end);
+        
+        // Prazo para início do atendimento, segundo a prioridade atribuída
+        if (patient->priority >= 1 && patient->priority <= NUM_PRIORITIES) {
+            set_patient_deadline(patient, atomic_load_explicit(&triage_sla_ms[patient->priority - 1],
+                                                               memory_order_relaxed));
+        }
+        
         write_log("TRIAGEM %d: Fim - Paciente %s (prioridade %d)", 
                  thread_id, patient->name, patient->priority);
         
@@ -289,6 +442,8 @@ void* triage_thread_function(void *arg) {
         update_triaged_stats(wait_time);
         
         // Enviar paciente para a fila de mensagens (atendimento)
+        patient->triage_thread = thread_id;
+        patient->queue_depth = get_queue_size();
         if (send_patient_to_queue(patient) != 0) {
             write_log("ERRO TRIAGEM %d: Falha ao enviar paciente %s para fila de atendimento",
                      thread_id, patient->name);
@@ -296,11 +451,105 @@ void* triage_thread_function(void *arg) {
         } else {
             write_log("TRIAGEM %d: Paciente %s enviado para atendimento", 
                      thread_id, patient->name);
+            // A mensagem leva uma cópia do paciente
+            free_patient(patient);
         }
+        atomic_fetch_add(&triage_queue->total_processed, 1);
+        
+        // Contabilizar tempo ocupado (utilização da thread, usada pelo autoscaler)
+        clock_gettime(CLOCK_MONOTONIC, &busy_end);
+        atomic_fetch_add_explicit(&self->busy_ns,
+            (busy_end.tv_sec - busy_start.tv_sec) * 1000000000LL +
+            (busy_end.tv_nsec - busy_start.tv_nsec), memory_order_relaxed);
+        worker_usage_add(usage, &usage_mark, &busy_start, &busy_end);
     }
     
+    worker_usage_stop(usage, &usage_mark);
     write_log("Thread de triagem %d a terminar", thread_id);
     
+    // Avisar o reaper de que esta posição pode ser recolhida
+    atomic_store_explicit(&self->state, TRIAGE_THREAD_EXITED, memory_order_release);
+    pthread_mutex_lock(&reaper_mutex);
+    reaper_pending = 1;
+    pthread_cond_signal(&reaper_cond);
+    pthread_mutex_unlock(&reaper_mutex);
+    
+    return NULL;
+}
+
+/*
+ * Cria a thread de triagem da posição 'slot' (ID = slot + 1)
+ * Retorna 0 em caso de sucesso, -1 em caso de erro
+ */
+static int spawn_triage_thread(int slot) {
+    TriageThreadInfo *info = &triage_threads[slot];
+    
+    info->id = slot + 1;
+    atomic_store_explicit(&info->busy_ns, 0, memory_order_relaxed);
+    atomic_store_explicit(&info->state, TRIAGE_THREAD_RUNNING, memory_order_relaxed);
+    
+    int *thread_id = malloc(sizeof(int));
+    if (thread_id == NULL) {
+        perror("Erro ao alocar memória para thread_id");
+        atomic_store(&info->state, TRIAGE_THREAD_FREE);
+        return -1;
+    }
+    *thread_id = slot + 1;
+    
+    // Fixar a thread numa CPU (round-robin pela lista TRIAGE_CPUS, pelo ID)
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    set_thread_attr_cpu(&attr, cpu_list_pick(&triage_cpu_list, slot));
+    
+    int create_result = pthread_create(&info->thread_id, &attr, triage_thread_function, thread_id);
+    pthread_attr_destroy(&attr);
+    
+    if (create_result != 0) {
+        // As funções pthread devolvem o erro em vez de o pôr em errno
+        fprintf(stderr, "Erro ao criar thread de triagem %d: %s\n", slot + 1, strerror(create_result));
+        write_log("ERRO: Falha ao criar thread de triagem %d: %s", slot + 1, strerror(create_result));
+        free(thread_id);
+        atomic_store(&info->state, TRIAGE_THREAD_FREE);
+        return -1;
+    }
+    
+    return 0;
+}
+
+/*
+ * Thread reaper: faz pthread_join das threads que terminaram (estado EXITED)
+ * e liberta as respetivas posições, sem bloquear quem pediu a redução
+ */
+static void* triage_reaper_function(void *arg) {
+    (void)arg;
+    
+    block_thread_signals();
+    
+    while (1) {
+        pthread_mutex_lock(&reaper_mutex);
+        while (!reaper_pending && reaper_running) {
+            pthread_cond_wait(&reaper_cond, &reaper_mutex);
+        }
+        int stop = !reaper_running;
+        reaper_pending = 0;
+        pthread_mutex_unlock(&reaper_mutex);
+        
+        if (stop) {
+            break;
+        }
+        
+        lock_mutex(&triage_control_mutex, LOCK_TRIAGE_CONTROL);
+        for (int i = 0; i < TRIAGE_MAX_THREADS; i++) {
+            if (atomic_load_explicit(&triage_threads[i].state, memory_order_acquire) == 
+                TRIAGE_THREAD_EXITED) {
+                pthread_join(triage_threads[i].thread_id, NULL);
+                atomic_store(&triage_threads[i].state, TRIAGE_THREAD_FREE);
+                write_log("Thread de triagem %d recolhida", triage_threads[i].id);
+            }
+        }
+        pthread_mutex_unlock(&triage_control_mutex);
+    }
+    
     return NULL;
 }
 
@@ -309,7 +558,7 @@ void* triage_thread_function(void *arg) {
  * Retorna 0 em caso de sucesso, -1 em caso de erro
  */
 int create_triage_threads(int num_threads, const Config *config) {
-    if (num_threads <= 0) {
+    if (num_threads <= 0 || num_threads > TRIAGE_MAX_THREADS) {
         fprintf(stderr, "ERRO: Número de threads inválido\n");
         return -1;
     }
@@ -318,10 +567,12 @@ int create_triage_threads(int num_threads, const Config *config) {
     printf("[DEBUG] A criar %d threads de triagem...\n", num_threads);
     #endif
     
-    // Guardar configuração global
-    global_triage_config = config;
+    update_triage_sla(config);
     num_triage_threads = num_threads;
     
+    // Lista de CPUs para afinidade (validada em load_config)
+    parse_cpu_list(config->triage_cpus, &triage_cpu_list);
+    
     // Criar fila de triagem
     triage_queue = create_triage_queue(config->triage_queue_max);
     if (triage_queue == NULL) {
@@ -329,8 +580,9 @@ int create_triage_threads(int num_threads, const Config *config) {
         return -1;
     }
     
-    // Alocar array para informação das threads
-    triage_threads = (TriageThreadInfo *)malloc(num_threads * sizeof(TriageThreadInfo));
+    // Alocar array para informação das threads (tamanho máximo, para que
+    // nunca mude de endereço enquanto as threads acedem à sua entrada)
+    triage_threads = (TriageThreadInfo *)malloc(TRIAGE_MAX_THREADS * sizeof(TriageThreadInfo));
     if (triage_threads == NULL) {
         perror("Erro ao alocar memória para triage_threads");
         destroy_triage_queue(triage_queue);
@@ -338,29 +590,29 @@ int create_triage_threads(int num_threads, const Config *config) {
         return -1;
     }
     
-    memset(triage_threads, 0, num_threads * sizeof(TriageThreadInfo));
+    memset(triage_threads, 0, TRIAGE_MAX_THREADS * sizeof(TriageThreadInfo));
     
     printf("\n=== Criação das Threads de Triagem ===\n");
     
+    // Iniciar o reaper antes das threads (recolhe as que vierem a terminar)
+    reaper_running = 1;
+    if (pthread_create(&reaper_thread, NULL, triage_reaper_function, NULL) != 0) {
+        perror("Erro ao criar thread reaper da triagem");
+        reaper_running = 0;
+        free(triage_threads);
+        triage_threads = NULL;
+        destroy_triage_queue(triage_queue);
+        triage_queue = NULL;
+        return -1;
+    }
+    
     // Criar cada thread
+    int created = 0;
     for (int i = 0; i < num_threads; i++) {
-        triage_threads[i].id = i + 1;
-        triage_threads[i].active = 1;
-        
-        int *thread_id = malloc(sizeof(int));
-        if (thread_id == NULL) {
-            perror("Erro ao alocar memória para thread_id");
-            continue;
-        }
-        *thread_id = i + 1;
-        
-        if (pthread_create(&triage_threads[i].thread_id, NULL, 
-                          triage_thread_function, thread_id) != 0) {
-            perror("Erro ao criar thread de triagem");
-            free(thread_id);
-            triage_threads[i].active = 0;
+        if (spawn_triage_thread(i) != 0) {
             continue;
         }
+        created++;
         
         #ifdef DEBUG
         printf("[DEBUG] Thread de triagem %d criada (TID: %lu)\n", 
@@ -368,7 +620,23 @@ int create_triage_threads(int num_threads, const Config *config) {
         #endif
     }
     
-    printf("=== %d Threads de Triagem criadas com sucesso ===\n\n", num_threads);
+    // Sem nenhuma thread o Admission aceitaria pacientes que nunca seriam triados
+    if (created == 0) {
+        write_log("ERRO: Nenhuma das %d threads de triagem foi criada", num_threads);
+        terminate_triage_threads();
+        return -1;
+    }
+    
+    num_triage_threads = created;
+    if (created < num_threads) {
+        write_log("AVISO: Só %d de %d threads de triagem foram criadas", created, num_threads);
+    }
+    
+    printf("=== %d Threads de Triagem criadas com sucesso ===\n\n", created);
+    
+    if (config->triage_autoscale && start_triage_autoscaler(config) != 0) {
+        write_log("AVISO: Falha ao iniciar autoscaler da triagem (número de threads fixo)");
+    }
     
     return 0;
 }
@@ -376,16 +644,19 @@ int create_triage_threads(int num_threads, const Config *config) {
 
 /*
  * Altera dinamicamente o número de threads de triagem
+ * Não bloqueia: as threads excedentes são marcadas como RETIRING, terminam
+ * depois do paciente que estão a triar e são recolhidas pelo reaper
  * Retorna 0 em caso de sucesso, -1 em caso de erro
  */
 int change_triage_threads(int new_num_threads, const Config *config) {
-    if (new_num_threads <= 0 || new_num_threads > config->triage_queue_max) {
+    if (new_num_threads <= 0 || new_num_threads > config->triage_queue_max ||
+        new_num_threads > TRIAGE_MAX_THREADS) {
         fprintf(stderr, "ERRO: Número de threads inválido (%d). Deve estar entre 1 e triage_queue_max.\n", 
                 new_num_threads);
         return -1;
     }
     
-    pthread_mutex_lock(&triage_control_mutex);
+    lock_mutex(&triage_control_mutex, LOCK_TRIAGE_CONTROL);
     
     write_log("=== ALTERAÇÃO DE THREADS DE TRIAGEM ===");
     write_log("Threads atuais: %d", num_triage_threads);
@@ -400,97 +671,230 @@ int change_triage_threads(int new_num_threads, const Config *config) {
     }
     
     if (new_num_threads > old_num_threads) {
-        // Aumentar o número de threads
+        // Aumentar o número de threads, usando as posições livres de menor ID
+        // (posições ainda a terminar não são reutilizadas antes de recolhidas)
         write_log("A aumentar de %d para %d threads...", old_num_threads, new_num_threads);
         
-        // Realocar array de threads
-        TriageThreadInfo *new_array = (TriageThreadInfo *)realloc(
-            triage_threads, 
-            new_num_threads * sizeof(TriageThreadInfo)
-        );
-        
-        if (new_array == NULL) {
-            perror("Erro ao realocar memória para threads de triagem");
-            pthread_mutex_unlock(&triage_control_mutex);
-            return -1;
-        }
-        
-        triage_threads = new_array;
-        
-        // Criar novas threads
-        for (int i = old_num_threads; i < new_num_threads; i++) {
-            triage_threads[i].id = i + 1;
-            triage_threads[i].active = 1;
-            
-            int *thread_id = malloc(sizeof(int));
-            if (thread_id == NULL) {
-                perror("Erro ao alocar memória para thread_id");
+        int created = 0;
+        for (int i = 0; i < TRIAGE_MAX_THREADS && old_num_threads + created < new_num_threads; i++) {
+            if (atomic_load(&triage_threads[i].state) != TRIAGE_THREAD_FREE) {
                 continue;
             }
-            *thread_id = i + 1;
-            
-            if (pthread_create(&triage_threads[i].thread_id, NULL, 
-                              triage_thread_function, thread_id) != 0) {
-                perror("Erro ao criar thread de triagem");
-                free(thread_id);
-                triage_threads[i].active = 0;
-                continue;
+            if (spawn_triage_thread(i) == 0) {
+                created++;
+                write_log("Thread de triagem %d criada (TID: %lu)", 
+                         i + 1, triage_threads[i].thread_id);
             }
-            
-            write_log("Thread de triagem %d criada (TID: %lu)", 
-                     i + 1, triage_threads[i].thread_id);
         }
         
-        num_triage_threads = new_num_threads;
-        write_log("Threads de triagem aumentadas para %d com sucesso", new_num_threads);
+        num_triage_threads = old_num_threads + created;
+        
+        if (num_triage_threads != new_num_threads) {
+            write_log("AVISO: Apenas %d threads de triagem disponíveis", num_triage_threads);
+        }
+        write_log("Threads de triagem aumentadas para %d com sucesso", num_triage_threads);
         
     } else {
-        // Diminuir o número de threads
+        // Diminuir o número de threads: retirar as ativas de maior ID
         write_log("A diminuir de %d para %d threads...", old_num_threads, new_num_threads);
         
-        // Marcar threads excedentes como inativas
-        for (int i = new_num_threads; i < old_num_threads; i++) {
-            if (triage_threads[i].active) {
-                triage_threads[i].active = 0;
+        int to_retire = old_num_threads - new_num_threads;
+        for (int i = TRIAGE_MAX_THREADS - 1; i >= 0 && to_retire > 0; i--) {
+            int expected = TRIAGE_THREAD_RUNNING;
+            if (atomic_compare_exchange_strong(&triage_threads[i].state, &expected, 
+                                               TRIAGE_THREAD_RETIRING)) {
+                to_retire--;
                 write_log("Thread de triagem %d marcada para terminação", triage_threads[i].id);
             }
         }
         
-        // Acordar todas as threads para que verifiquem se devem terminar
-        pthread_mutex_lock(&triage_queue->mutex);
+        num_triage_threads = new_num_threads + to_retire;
+        
+        // Acordar as threads bloqueadas na fila para que verifiquem o seu estado
+        lock_mutex(&triage_queue->mutex, LOCK_TRIAGE_QUEUE);
         pthread_cond_broadcast(&triage_queue->not_empty);
         pthread_mutex_unlock(&triage_queue->mutex);
         
-        // Aguardar que as threads excedentes terminem
-        for (int i = new_num_threads; i < old_num_threads; i++) {
-            if (triage_threads[i].thread_id != 0) {
-                pthread_join(triage_threads[i].thread_id, NULL);
-                write_log("Thread de triagem %d terminada", triage_threads[i].id);
-            }
+        write_log("Threads de triagem diminuídas para %d (as restantes terminam em segundo plano)", 
+                 num_triage_threads);
+    }
+    
+    write_log("=== ALTERAÇÃO CONCLUÍDA ===");
+    
+    pthread_mutex_unlock(&triage_control_mutex);
+    
+    return 0;
+}
+
+/*
+ * Thread do autoscaler: amostra periodicamente a fila de triagem e a
+ * utilização das threads e ajusta a pool entre triage_min e triage_max.
+ *
+ * Número desejado = carga / utilização alvo, sendo a carga o maior entre
+ * as threads ocupadas e a carga oferecida (taxa de chegada x tempo médio
+ * de triagem), mais um reforço proporcional aos pacientes em espera.
+ * Só cresce após
+ * AUTOSCALE_GROW_SAMPLES amostras seguidas acima do atual e só encolhe após
+ * AUTOSCALE_SHRINK_SAMPLES amostras seguidas abaixo (histerese).
+ */
+static void* triage_autoscaler_function(void *arg) {
+    const Config *config = (const Config *)arg;
+    
+    block_thread_signals();
+    
+    int min_threads = config->triage_min;
+    int max_threads = config->triage_max;
+    if (max_threads > config->triage_queue_max) {
+        max_threads = config->triage_queue_max;
+    }
+    if (min_threads > max_threads) {
+        min_threads = max_threads;
+    }
+    
+    long long last_busy[TRIAGE_MAX_THREADS] = {0};
+    long last_enqueued = 0;
+    long last_processed = atomic_load(&triage_queue->total_processed);
+    double mean_triage_s = 0;   // Tempo médio de triagem (última amostra com saídas)
+    int grow_samples = 0, shrink_samples = 0;
+    int last_current = num_triage_threads;
+    
+    write_log("Autoscaler da triagem iniciado (%d a %d threads)", min_threads, max_threads);
+    
+    while (autoscaler_running && triage_system_running) {
+        usleep(AUTOSCALE_INTERVAL_MS * 1000);
+        
+        // Profundidade da fila e taxa de chegada
+        lock_mutex(&triage_queue->mutex, LOCK_TRIAGE_QUEUE);
+        int depth = triage_queue->count;
+        long enqueued = triage_queue->total_enqueued;
+        pthread_mutex_unlock(&triage_queue->mutex);
+        
+        double interval = AUTOSCALE_INTERVAL_MS / 1000.0;
+        double arrival_rate = (enqueued - last_enqueued) / interval;
+        last_enqueued = enqueued;
+        
+        long processed = atomic_load(&triage_queue->total_processed);
+        long processed_delta = processed - last_processed;
+        last_processed = processed;
+        
+        // Tempo ocupado de todas as threads desde a última amostra
+        lock_mutex(&triage_control_mutex, LOCK_TRIAGE_CONTROL);
+        int current = num_triage_threads;
+        long long busy_delta = 0;
+        for (int i = 0; i < TRIAGE_MAX_THREADS; i++) {
+            long long busy = atomic_load_explicit(&triage_threads[i].busy_ns, memory_order_relaxed);
+            // busy < last_busy: a posição foi reutilizada por uma thread nova
+            busy_delta += (busy >= last_busy[i]) ? busy - last_busy[i] : busy;
+            last_busy[i] = busy;
+        }
+        pthread_mutex_unlock(&triage_control_mutex);
+        
+        // Alteração feita por outra via (TRIAGE=X): recomeçar a contagem
+        if (current != last_current) {
+            grow_samples = 0;
+            shrink_samples = 0;
+            last_current = current;
         }
         
-        num_triage_threads = new_num_threads;
+        double busy_threads = busy_delta / (interval * 1e9);
+        double utilization = busy_threads / current;
         
-        // Redimensionar array (opcional, para libertar memória)
-        TriageThreadInfo *new_array = (TriageThreadInfo *)realloc(
-            triage_threads, 
-            new_num_threads * sizeof(TriageThreadInfo)
-        );
+        // Carga oferecida (lei de Little): antecipa chegadas que ainda não ocupam threads
+        if (processed_delta > 0) {
+            mean_triage_s = busy_delta / 1e9 / processed_delta;
+        }
+        double offered = arrival_rate * mean_triage_s;
+        double load = (offered > busy_threads) ? offered : busy_threads;
         
-        if (new_array != NULL) {
-            triage_threads = new_array;
+        int desired = (int)(load / AUTOSCALE_TARGET_UTIL + 0.999);
+        if (depth > 0) {
+            // Pacientes à espera: reforçar, no máximo duplicando a pool
+            int backlog = (depth < current) ? depth : current;
+            if (desired < current + backlog) {
+                desired = current + backlog;
+            }
         }
+        if (desired < min_threads) desired = min_threads;
+        if (desired > max_threads) desired = max_threads;
+        
+        #ifdef DEBUG
+        printf("[DEBUG] Autoscaler: fila=%d, chegadas=%.1f/s, triagem=%.1f ms, utilização=%.2f, threads=%d, desejado=%d\n",
+               depth, arrival_rate, mean_triage_s * 1000, utilization, current, desired);
+        #endif
         
-        write_log("Threads de triagem diminuídas para %d com sucesso", new_num_threads);
+        if (desired > current) {
+            shrink_samples = 0;
+            if (++grow_samples >= AUTOSCALE_GROW_SAMPLES) {
+                write_log("AUTOSCALER: Fila=%d, chegadas=%.1f/s, utilização=%.0f%% -> %d threads",
+                         depth, arrival_rate, utilization * 100, desired);
+                change_triage_threads(desired, config);
+                last_current = desired;
+                grow_samples = 0;
+            }
+        } else if (desired < current && utilization < AUTOSCALE_LOW_UTIL) {
+            grow_samples = 0;
+            if (++shrink_samples >= AUTOSCALE_SHRINK_SAMPLES) {
+                // Encolher no máximo para metade de cada vez
+                int target = (desired > current / 2) ? desired : current / 2;
+                if (target < min_threads) target = min_threads;
+                write_log("AUTOSCALER: Fila=%d, chegadas=%.1f/s, utilização=%.0f%% -> %d threads",
+                         depth, arrival_rate, utilization * 100, target);
+                change_triage_threads(target, config);
+                last_current = target;
+                shrink_samples = 0;
+            }
+        } else {
+            grow_samples = 0;
+            shrink_samples = 0;
+        }
     }
     
-    write_log("=== ALTERAÇÃO CONCLUÍDA ===");
+    write_log("Autoscaler da triagem terminado");
     
-    pthread_mutex_unlock(&triage_control_mutex);
+    return NULL;
+}
+
+/*
+ * Atualiza os prazos de SLA usados pelas threads de triagem
+ * (no arranque e a cada recarregamento da configuração)
+ */
+void update_triage_sla(const Config *config) {
+    for (int i = 0; i < NUM_PRIORITIES; i++) {
+        atomic_store_explicit(&triage_sla_ms[i], config->sla_target_ms[i], memory_order_relaxed);
+    }
+}
+
+/*
+ * Inicia a thread do autoscaler (com uma cópia de 'config': o
+ * recarregamento reinicia-o quando os seus parâmetros mudam)
+ * Retorna 0 em caso de sucesso, -1 em caso de erro
+ */
+int start_triage_autoscaler(const Config *config) {
+    autoscaler_config = *config;
+    autoscaler_running = 1;
+    
+    if (pthread_create(&autoscaler_thread, NULL, triage_autoscaler_function, 
+                       &autoscaler_config) != 0) {
+        perror("Erro ao criar thread do autoscaler");
+        autoscaler_running = 0;
+        return -1;
+    }
     
     return 0;
 }
 
+/*
+ * Pára a thread do autoscaler (se estiver a correr)
+ */
+void stop_triage_autoscaler() {
+    if (!autoscaler_running) {
+        return;
+    }
+    
+    autoscaler_running = 0;
+    pthread_join(autoscaler_thread, NULL);
+}
+
 /*
  * Termina todas as threads de triagem
  */
@@ -501,17 +905,27 @@ void terminate_triage_threads() {
     
     printf("\n=== Terminação das Threads de Triagem ===\n");
     
+    // Parar o autoscaler antes de mexer na pool
+    stop_triage_autoscaler();
+    
     // Sinalizar que o sistema está a terminar
     triage_system_running = 0;
     
     // Acordar todas as threads que possam estar bloqueadas
-    pthread_mutex_lock(&triage_queue->mutex);
+    lock_mutex(&triage_queue->mutex, LOCK_TRIAGE_QUEUE);
     pthread_cond_broadcast(&triage_queue->not_empty);
     pthread_mutex_unlock(&triage_queue->mutex);
     
+    // Parar o reaper; as threads que faltam recolher são recolhidas aqui
+    pthread_mutex_lock(&reaper_mutex);
+    reaper_running = 0;
+    pthread_cond_signal(&reaper_cond);
+    pthread_mutex_unlock(&reaper_mutex);
+    pthread_join(reaper_thread, NULL);
+    
     // Aguardar pela terminação de todas as threads
-    for (int i = 0; i < num_triage_threads; i++) {
-        if (triage_threads[i].active) {
+    for (int i = 0; i < TRIAGE_MAX_THREADS; i++) {
+        if (atomic_load(&triage_threads[i].state) != TRIAGE_THREAD_FREE) {
             #ifdef DEBUG
             printf("[DEBUG] A aguardar terminação da thread de triagem %d...\n", 
                    triage_threads[i].id);
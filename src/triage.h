@@ -9,10 +9,19 @@
 #define TRIAGE_H
 
 #include <pthread.h>
+#include <stdatomic.h>
 #include "config.h"
 #include "patient.h"
 
 #define TRIAGE_QUEUE_NAME_SIZE 128
+#define TRIAGE_MAX_THREADS 100          // Limite de threads (TRIAGE=X: 1-100)
+
+/* Parâmetros do autoscaling das threads de triagem */
+#define AUTOSCALE_INTERVAL_MS 500       // Período de amostragem
+#define AUTOSCALE_TARGET_UTIL 0.70      // Utilização alvo por thread
+#define AUTOSCALE_LOW_UTIL 0.30         // Abaixo disto a pool pode encolher
+#define AUTOSCALE_GROW_SAMPLES 2        // Amostras consecutivas para crescer
+#define AUTOSCALE_SHRINK_SAMPLES 6      // Amostras consecutivas para encolher
 
 /* Estrutura para a fila de triagem */
 typedef struct {
@@ -21,16 +30,25 @@ typedef struct {
     int rear;                    // Índice do fim da fila
     int count;                   // Número de pacientes na fila
     int capacity;                // Capacidade máxima da fila
+    long total_enqueued;         // Total de pacientes que entraram (taxa de chegada)
+    atomic_long total_processed; // Pacientes que já saíram da triagem (enviados ou perdidos)
     pthread_mutex_t mutex;       // Mutex para sincronização
     pthread_cond_t not_empty;    // Condição: fila não vazia
     pthread_cond_t not_full;     // Condição: fila não cheia
 } TriageQueue;
 
+/* Estados de uma posição da pool de threads de triagem */
+#define TRIAGE_THREAD_FREE     0    // Posição livre (thread recolhida)
+#define TRIAGE_THREAD_RUNNING  1    // Thread ativa
+#define TRIAGE_THREAD_RETIRING 2    // Marcada para terminar (redução da pool)
+#define TRIAGE_THREAD_EXITED   3    // Terminou, à espera do reaper (pthread_join)
+
 /* Estrutura para informação de cada thread de triagem */
 typedef struct {
     pthread_t thread_id;         // ID da thread
     int id;                      // ID da thread (1, 2, 3, ...)
-    int active;                  // Flag: 1 = ativa, 0 = terminada
+    atomic_int state;            // Estado (TRIAGE_THREAD_*)
+    atomic_llong busy_ns;        // Tempo ocupado a triar (atualizado pela própria thread)
 } TriageThreadInfo;
 
 /* Variáveis globais */
@@ -39,14 +57,19 @@ extern TriageThreadInfo *triage_threads;
 extern int num_triage_threads;
 extern volatile int triage_system_running;
 
-/* Mutex para controlar alterações no número de threads */
+/* Mutex para controlar alterações no número de threads (resize e reaper) */
 extern pthread_mutex_t triage_control_mutex;
 
 /* Funções para gestão da fila de triagem */
 TriageQueue* create_triage_queue(int capacity);
 int enqueue_patient(TriageQueue *queue, Patient *patient);
+int enqueue_patients(TriageQueue *queue, Patient **patients, int count);
 Patient* dequeue_patient(TriageQueue *queue);
+Patient* dequeue_patient_active(TriageQueue *queue, atomic_int *state);
 void destroy_triage_queue(TriageQueue *queue);
+int get_triage_pending(TriageQueue *queue);
+int snapshot_triage_queue(TriageQueue *queue, Patient *out, int max, long *accepted, int *omitted);
+void set_triage_accepted(TriageQueue *queue, long accepted);
 
 /* Funções para gestão das threads de triagem */
 int create_triage_threads(int num_threads, const Config *config);
@@ -55,5 +78,10 @@ void terminate_triage_threads();
 
 /* Funções para alteração dinâmica */
 int change_triage_threads(int new_num_threads, const Config *config);
+void update_triage_sla(const Config *config);
+
+/* Autoscaling das threads de triagem */
+int start_triage_autoscaler(const Config *config);
+void stop_triage_autoscaler();
 
 #endif // TRIAGE_H
\ No newline at end of file